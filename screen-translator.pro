@@ -15,7 +15,31 @@ win32{
 }
 linux{
   QT += x11extras
-  LIBS += -lX11
+  LIBS += -lX11 -ldl
+  # fallback for hotkeys, grabbed by other programs
+  packagesExist(xcb-xinput) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += xcb xcb-xinput
+    DEFINES += WITH_XINPUT2
+  }
+}
+
+# optional pdf documents support
+exists($$DEPS_DIR/include/poppler/qt5/poppler-qt5.h) {
+  INCLUDEPATH += $$DEPS_DIR/include/poppler/qt5
+  LIBS += -lpoppler-qt5
+  DEFINES += WITH_POPPLER
+} else:packagesExist(poppler-qt5) {
+  CONFIG += link_pkgconfig
+  PKGCONFIG += poppler-qt5
+  DEFINES += WITH_POPPLER
+}
+
+# optional scalable allocator for many small strings of correction,
+# enabled with "qmake CONFIG+=mimalloc"
+mimalloc {
+  LIBS += -lmimalloc
+  DEFINES += WITH_MIMALLOC
 }
 
 SOURCES += $$PWD/external/miniz/miniz.c
@@ -36,16 +60,31 @@ HEADERS += \
   src/capture/capturearea.h \
   src/capture/captureareaeditor.h \
   src/capture/captureareaselector.h \
+  src/capture/changedetector.h \
   src/capture/capturer.h \
+  src/capture/pdfdocument.h \
   src/commonmodels.h \
+  src/correct/confusionmatrix.h \
   src/correct/corrector.h \
   src/correct/correctorworker.h \
   src/correct/hunspellcorrector.h \
+  src/correct/ngramcorrector.h \
+  src/correct/ngrammodel.h \
+  src/correct/substitutiondfa.h \
+  src/correct/usersubstitutions.h \
   src/languagecodes.h \
   src/manager.h \
+  src/ocr/imagetiles.h \
+  src/ocr/incrementalrecognizer.h \
+  src/ocr/ocrprocess.h \
+  src/ocr/orientationdetector.h \
+  src/ocr/parallelismplanner.h \
+  src/ocr/pixpool.h \
   src/ocr/recognizer.h \
   src/ocr/recognizerworker.h \
   src/ocr/tesseract.h \
+  src/ocr/textlayout.h \
+  src/pipeline.h \
   src/represent/representer.h \
   src/represent/resulteditor.h \
   src/represent/resultwidget.h \
@@ -53,7 +92,10 @@ HEADERS += \
   src/service/debug.h \
   src/service/geometryutils.h \
   src/service/globalaction.h \
+  src/service/latencymonitor.h \
+  src/service/memoryregistry.h \
   src/service/runatsystemstart.h \
+  src/service/threadscheduling.h \
   src/service/singleapplication.h \
   src/service/updates.h \
   src/service/widgetstate.h \
@@ -62,6 +104,8 @@ HEADERS += \
   src/stfwd.h \
   src/substitutionstable.h \
   src/task.h \
+  src/taskorder.h \
+  src/translate/translationdiff.h \
   src/translate/translator.h \
   src/translate/webpage.h \
   src/translate/webpageproxy.h \
@@ -71,17 +115,32 @@ SOURCES += \
   src/capture/capturearea.cpp \
   src/capture/captureareaeditor.cpp \
   src/capture/captureareaselector.cpp \
+  src/capture/changedetector.cpp \
   src/capture/capturer.cpp \
+  src/capture/pdfdocument.cpp \
   src/commonmodels.cpp \
+  src/correct/confusionmatrix.cpp \
   src/correct/corrector.cpp \
   src/correct/correctorworker.cpp \
   src/correct/hunspellcorrector.cpp \
+  src/correct/ngramcorrector.cpp \
+  src/correct/ngrammodel.cpp \
+  src/correct/substitutiondfa.cpp \
+  src/correct/usersubstitutions.cpp \
   src/languagecodes.cpp \
   src/main.cpp \
   src/manager.cpp \
+  src/ocr/imagetiles.cpp \
+  src/ocr/incrementalrecognizer.cpp \
+  src/ocr/ocrprocess.cpp \
+  src/ocr/orientationdetector.cpp \
+  src/ocr/parallelismplanner.cpp \
+  src/ocr/pixpool.cpp \
   src/ocr/recognizer.cpp \
   src/ocr/recognizerworker.cpp \
   src/ocr/tesseract.cpp \
+  src/ocr/textlayout.cpp \
+  src/pipeline.cpp \
   src/represent/representer.cpp \
   src/represent/resulteditor.cpp \
   src/represent/resultwidget.cpp \
@@ -89,13 +148,18 @@ SOURCES += \
   src/service/debug.cpp \
   src/service/geometryutils.cpp \
   src/service/globalaction.cpp \
+  src/service/latencymonitor.cpp \
+  src/service/memoryregistry.cpp \
   src/service/runatsystemstart.cpp \
+  src/service/threadscheduling.cpp \
   src/service/singleapplication.cpp \
   src/service/updates.cpp \
   src/service/widgetstate.cpp \
   src/settings.cpp \
   src/settingseditor.cpp \
   src/substitutionstable.cpp \
+  src/taskorder.cpp \
+  src/translate/translationdiff.cpp \
   src/translate/translator.cpp \
   src/translate/webpage.cpp \
   src/translate/webpageproxy.cpp \
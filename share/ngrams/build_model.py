@@ -0,0 +1,66 @@
+import sys
+import math
+import struct
+import re
+from collections import Counter
+
+# Builds n-gram language model (.stlm) used by NgramCorrector.
+# Format: header (magic, version, order, count, unknown log10 prob,
+# backoff penalty, 256 quantization levels), sorted FNV-1a 64 hashes of
+# lowercase n-grams (words joined with space), quantization codes.
+
+if len(sys.argv) < 3:
+    print("Usage:", sys.argv[0], "<corpus.txt> <output.stlm> [<order>]")
+    exit(1)
+
+corpus_file = sys.argv[1]
+output_file = sys.argv[2]
+order = int(sys.argv[3]) if len(sys.argv) > 3 else 3
+min_count = 2
+backoff_penalty = math.log10(0.4)
+levels = 256
+
+
+def fnv1a(text):
+    hash = 14695981039346656037
+    for byte in text.encode('utf-8'):
+        hash ^= byte
+        hash = (hash * 1099511628211) & 0xffffffffffffffff
+    return hash
+
+
+counts = [Counter() for _ in range(order + 1)]
+word_re = re.compile(r"[\w']+")
+with open(corpus_file, 'r', encoding='utf-8') as f:
+    for line in f:
+        words = word_re.findall(line.lower())
+        counts[0][()] += len(words)
+        for n in range(1, order + 1):
+            for i in range(len(words) - n + 1):
+                counts[n][tuple(words[i:i + n])] += 1
+
+probs = {}
+for n in range(1, order + 1):
+    for ngram, count in counts[n].items():
+        if n > 1 and count < min_count:
+            continue
+        context = counts[n - 1][ngram[:-1]]
+        hash = fnv1a(' '.join(ngram))
+        probs[hash] = math.log10(count / context)
+
+total = max(counts[0][()], 1)
+unknown = math.log10(0.5 / total)
+lowest = min(list(probs.values()) + [unknown])
+step = -lowest / (levels - 1) if lowest < 0 else 1
+quantization = [lowest + i * step for i in range(levels)]
+
+hashes = sorted(probs.keys())
+with open(output_file, 'wb') as f:
+    f.write(b'STLM')
+    f.write(struct.pack('<IIIff', 1, order, len(hashes),
+                        unknown, backoff_penalty))
+    f.write(struct.pack('<%df' % levels, *quantization))
+    f.write(struct.pack('<%dQ' % len(hashes), *hashes))
+    f.write(bytes(int(round((probs[h] - lowest) / step)) for h in hashes))
+
+print('Written', len(hashes), 'n-grams to', output_file)
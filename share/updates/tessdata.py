@@ -19,16 +19,26 @@ def parse_language_names():
 
 
 if len(sys.argv) < 2:
-    print("Usage:", sys.argv[0], "<tessdata_dir> [<download_url>]")
+    print("Usage:", sys.argv[0],
+          "<tessdata_dir> [<download_url>] [best|fast]")
     exit(1)
 
 tessdata_dir = sys.argv[1]
 
-download_url = "https://github.com/tesseract-ocr/tessdata_best/raw/master"
-if len(sys.argv) > 2:
+variant = 'best'
+if len(sys.argv) > 3:
+    variant = sys.argv[3]
+
+download_url = "https://github.com/tesseract-ocr/tessdata_{}/raw/master".format(
+    variant)
+if len(sys.argv) > 2 and len(sys.argv[2]) > 0:
     download_url = sys.argv[2]
 
-mirror_url = "https://translator.gres.biz/resources/tessdata_best"
+mirror_url = "https://translator.gres.biz/resources/tessdata_" + variant
+
+# fast models are installed side by side with best ones
+group_name = 'recognizers' if variant == 'best' else 'recognizers_' + variant
+path_prefix = '$tessdata$' if variant == 'best' else '$tessdata$/' + variant
 
 language_names = parse_language_names()
 
@@ -42,7 +52,7 @@ for f in it:
         continue
     files.setdefault(name, []).append(f.name)
 
-print(',"recognizers": {')
+print(',"{}": {{'.format(group_name))
 comma = ''
 unknown_names = []
 for name in sorted(files.keys()):
@@ -60,8 +70,8 @@ for name in sorted(files.keys()):
         size = os.path.getsize(os.path.join(tessdata_dir, file_name))
         mirror = ',"' + mirror_url + '/' + file_name + \
             '.zip"' if len(mirror_url) > 0 else ''
-        print('  {{"url":["{}/{}"{}], "path":"$tessdata$/{}", "date":"{}", "size":{}}}'.format(
-            download_url, file_name, mirror, file_name, date, size))
+        print('  {{"url":["{}/{}"{}], "path":"{}/{}", "date":"{}", "size":{}}}'.format(
+            download_url, file_name, mirror, path_prefix, file_name, date, size))
     print(' ]}')
 print('}')
 
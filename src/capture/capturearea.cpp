@@ -6,21 +6,47 @@ CaptureArea::CaptureArea(const QRect &rect, const Settings &settings)
   : rect_(rect)
   , doTranslation_(settings.doTranslation)
   , useHunspell_(settings.useHunspell)
+  , useLanguageModel_(settings.useLanguageModel)
+  , useFastModel_(settings.useFastModels)
+  , retryLowConfidence_(settings.retryLowConfidence)
+  , detectOrientation_(settings.detectOrientation)
   , sourceLanguage_(settings.sourceLanguage)
   , targetLanguage_(settings.targetLanguage)
   , translators_(settings.translators)
 {
 }
 
-TaskPtr CaptureArea::task(const QPixmap &pixmap) const
+TaskPtr CaptureArea::task(const QPixmap &pixmap, const QPoint &origin) const
 {
   if (pixmap.isNull() || !isValid())
     return {};
 
+  auto task = makeTask();
+  task->captured = pixmap.copy(rect_.translated(-origin));
+  return task;
+}
+
+TaskPtr CaptureArea::textTask(const QString &text) const
+{
+  if (text.isEmpty())
+    return {};
+
+  auto task = makeTask();
+  task->isText = true;
+  task->recognized = text;
+  task->corrected = text;
+  return task;
+}
+
+TaskPtr CaptureArea::makeTask() const
+{
   auto task = std::make_shared<Task>();
   task->generation = generation_;
   task->useHunspell = useHunspell_;
-  task->captured = pixmap.copy(rect_);
+  task->useLanguageModel = useLanguageModel_;
+  task->useFastModel = useFastModel_;
+  task->retryLowConfidence = retryLowConfidence_;
+  task->detectOrientation = detectOrientation_;
   task->capturePoint = rect_.topLeft();
   task->sourceLanguage = sourceLanguage_;
   if (task->sourceLanguage.isEmpty())
@@ -11,7 +11,10 @@ class CaptureArea
 {
 public:
   CaptureArea(const QRect& rect, const Settings& settings);
-  TaskPtr task(const QPixmap& pixmap) const;
+  // pixmap origin is its position on desktop
+  TaskPtr task(const QPixmap& pixmap, const QPoint& origin = {}) const;
+  // already recognized text, e.g. selected by user
+  TaskPtr textTask(const QString& text) const;
 
   void setGeneration(uint generation);
   bool isValid() const;
@@ -24,11 +27,17 @@ public:
 private:
   friend class CaptureAreaEditor;
 
+  TaskPtr makeTask() const;
+
   Generation generation_{};
   QRect rect_;
   bool doTranslation_;
   bool isLocked_{false};
   bool useHunspell_{false};
+  bool useLanguageModel_{false};
+  bool useFastModel_{false};
+  bool retryLowConfidence_{false};
+  bool detectOrientation_{false};
   LanguageId sourceLanguage_;
   LanguageId targetLanguage_;
   QStringList translators_;
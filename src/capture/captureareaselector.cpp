@@ -77,6 +77,23 @@ void CaptureAreaSelector::captureLocked()
   }
 }
 
+void CaptureAreaSelector::watchLocked()
+{
+  SOFT_ASSERT(hasLocked(), return );
+  ++generation_;
+  for (auto &area : areas_) {
+    if (!area->isLocked())
+      continue;
+    area->setGeneration(generation_);
+    capturer_.watched(*area);
+  }
+}
+
+Generation CaptureAreaSelector::nextGeneration()
+{
+  return ++generation_;
+}
+
 void CaptureAreaSelector::capture(CaptureArea &area, uint generation)
 {
   area.setGeneration(generation);
@@ -18,6 +18,8 @@ public:
   void activate();
   bool hasLocked() const;
   void captureLocked();
+  void watchLocked();
+  Generation nextGeneration();
   void setScreenRects(const std::vector<QRect> &screens);
   void updateSettings();
 
@@ -1,12 +1,17 @@
 #include "capturer.h"
 #include "capturearea.h"
 #include "captureareaselector.h"
+#include "changedetector.h"
 #include "debug.h"
 #include "manager.h"
+#include "memoryregistry.h"
+#include "pdfdocument.h"
 #include "settings.h"
 #include "task.h"
 
 #include <QApplication>
+#include <QCursor>
+#include <QImageReader>
 #include <QPainter>
 #include <QScreen>
 
@@ -41,6 +46,147 @@ void Capturer::captureLocked()
   selector_->captureLocked();
 }
 
+void Capturer::watchLocked()
+{
+  SOFT_ASSERT(selector_, return );
+  if (selector_->isVisible())  // would grab selector itself
+    return;
+
+  watchedKeys_.clear();
+  selector_->watchLocked();
+
+  for (auto it = changeDetectors_.begin(), end = changeDetectors_.end();
+       it != end;) {
+    if (watchedKeys_.contains(it->first))
+      ++it;
+    else
+      it = changeDetectors_.erase(it);
+  }
+}
+
+void Capturer::resetWatched()
+{
+  changeDetectors_.clear();
+}
+
+void Capturer::captureText(const QString &text)
+{
+  SOFT_ASSERT(selector_, return );
+  CaptureArea area(QRect(QCursor::pos(), QSize()), settings_);
+  area.setGeneration(selector_->nextGeneration());
+
+  auto task = area.textTask(text);
+  SOFT_ASSERT(task, return );
+  manager_.captured(task);
+}
+
+void Capturer::captureImages(const QStringList &files)
+{
+  SOFT_ASSERT(selector_, return );
+  const auto generation = selector_->nextGeneration();
+
+  // full images are read by recognizer, tasks hold only previews
+  const auto previewSize = QSize(800, 600);
+  const auto cascadeStep = QPoint(30, 30);
+  auto point = QCursor::pos();
+  for (const auto &file : files) {
+    QImageReader reader(file);
+    const auto size = reader.size();
+    if (size.isValid() && (size.width() > previewSize.width() ||
+                           size.height() > previewSize.height()))
+      reader.setScaledSize(size.scaled(previewSize, Qt::KeepAspectRatio));
+    const auto preview = QPixmap::fromImageReader(&reader);
+    if (preview.isNull()) {
+      LTRACE() << "Failed to read image preview" << file
+               << reader.errorString();
+      continue;
+    }
+
+    CaptureArea area(QRect(point, preview.size()), settings_);
+    area.setGeneration(generation);
+    auto task = area.task(preview, point);
+    if (!task)
+      continue;
+    task->imageFile = file;
+    manager_.captured(task);
+    point += cascadeStep;
+  }
+}
+
+void Capturer::captureImage(const QImage &image)
+{
+  SOFT_ASSERT(selector_, return );
+  const auto point = QCursor::pos();
+  CaptureArea area(QRect(point, image.size()), settings_);
+  area.setGeneration(selector_->nextGeneration());
+
+  auto task = area.task(QPixmap::fromImage(image), point);
+  if (task)
+    manager_.captured(task);
+}
+
+QString Capturer::captureDocument(const QString &file)
+{
+  SOFT_ASSERT(selector_, return {});
+  if (document_)
+    return QObject::tr("Another document is being recognized");
+
+  auto document = std::make_unique<PdfDocument>(file, settings_.documentDpi,
+                                                settings_.documentLayout);
+  if (!document->error().isEmpty())
+    return document->error();
+  if (document->pageCount() == 0)
+    return QObject::tr("Document has no pages: %1").arg(file);
+
+  document_ = std::move(document);
+  documentGeneration_ = selector_->nextGeneration();
+  capturePages();
+  return {};
+}
+
+void Capturer::finishPage(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
+  SOFT_ASSERT(document_, return );
+  LTRACE() << "Document page finished" << LARG(task->documentPage)
+           << task->error;
+
+  if (task->isValid())
+    document_->setText(task->documentPage, task->corrected, task->layout);
+  else
+    document_->setText(task->documentPage, {}, TextLayout());
+  if (!document_->isFinished()) {
+    capturePages();
+    return;
+  }
+
+  const auto error = document_->write() ? QString() : document_->error();
+  const auto outputName = document_->outputName();
+  document_.reset();
+  manager_.documentRecognized(outputName, error);
+}
+
+void Capturer::capturePages()
+{
+  // next pages are rendered when previous ones are finished
+  // failed pages are finished immediately and may finish the document
+  while (document_ && document_->canRenderPage()) {
+    auto page = -1;
+    const auto image = document_->renderPage(page);
+
+    CaptureArea area(QRect(QPoint(), image.size()), settings_);
+    area.setGeneration(documentGeneration_);
+    auto task = area.task(QPixmap::fromImage(image));
+    if (!task) {
+      task = std::make_shared<Task>();
+      task->generation = documentGeneration_;
+      task->error = QObject::tr("Failed to render page %1").arg(page + 1);
+    }
+    task->documentPage = page;
+    manager_.captured(task);
+  }
+}
+
 void Capturer::updatePixmap()
 {
   const auto screens = QApplication::screens();
@@ -69,12 +215,45 @@ void Capturer::updatePixmap()
   selector_->setScreenRects(screenRects);
 }
 
+QPixmap Capturer::grab(const QRect &rect)
+{
+  // only the area to avoid copying of whole desktop on every tick
+  for (const QScreen *screen : QApplication::screens()) {
+    const auto geometry = screen->geometry();
+    if (!geometry.contains(rect))
+      continue;
+    const auto local = rect.translated(-geometry.topLeft());
+    return screen->grabWindow(0, local.x(), local.y(), local.width(),
+                              local.height());
+  }
+
+  // spans several screens
+  updatePixmap();
+  return pixmap_.copy(rect);
+}
+
 void Capturer::repeatCapture()
 {
   SOFT_ASSERT(selector_, return );
+  if (pixmap_.isNull())  // released
+    updatePixmap();
   selector_->activate();
 }
 
+qint64 Capturer::memoryUsage() const
+{
+  const auto cells = ChangeDetector::gridSize * ChangeDetector::gridSize;
+  return service::MemoryRegistry::pixmapBytes(pixmap_) +
+         qint64(changeDetectors_.size()) * cells * 2;
+}
+
+void Capturer::releaseMemory()
+{
+  SOFT_ASSERT(selector_, return );
+  if (!selector_->isVisible())
+    pixmap_ = QPixmap();
+}
+
 void Capturer::updateSettings()
 {
   SOFT_ASSERT(selector_, return );
@@ -94,6 +273,32 @@ void Capturer::selected(const CaptureArea &area)
     manager_.captureCanceled();
 }
 
+void Capturer::watched(const CaptureArea &area)
+{
+  const auto rect = area.rect();
+  const auto pixmap = grab(rect);
+  if (pixmap.isNull())
+    return;
+
+  const auto key = QStringLiteral("%1,%2,%3x%4")
+                       .arg(rect.left())
+                       .arg(rect.top())
+                       .arg(rect.width())
+                       .arg(rect.height());
+  watchedKeys_.insert(key);
+  auto &detector = changeDetectors_[key];
+  if (!detector)
+    detector = std::make_unique<ChangeDetector>();
+  if (!detector->isChanged(pixmap.toImage()))
+    return;
+
+  auto task = area.task(pixmap, rect.topLeft());
+  if (!task)
+    return;
+  task->isWatched = true;
+  manager_.captured(task);
+}
+
 void Capturer::canceled()
 {
   SOFT_ASSERT(selector_, return );
@@ -3,6 +3,12 @@
 #include "stfwd.h"
 
 #include <QPixmap>
+#include <QSet>
+
+#include <map>
+
+class ChangeDetector;
+class PdfDocument;
 
 class Capturer
 {
@@ -14,17 +20,34 @@ public:
   void capture();
   bool canCaptureLocked();
   void captureLocked();
+  void watchLocked();
+  void resetWatched();
+  void captureText(const QString &text);
+  void captureImages(const QStringList &files);
+  void captureImage(const QImage &image);
+  // Returns error, empty if started.
+  QString captureDocument(const QString &file);
+  void finishPage(const TaskPtr &task);
   void repeatCapture();
   void updateSettings();
+  qint64 memoryUsage() const;
+  void releaseMemory();
 
   void selected(const CaptureArea &area);
+  void watched(const CaptureArea &area);
   void canceled();
 
 private:
   void updatePixmap();
+  QPixmap grab(const QRect &rect);
+  void capturePages();
 
   Manager &manager_;
   const Settings &settings_;
   QPixmap pixmap_;
   std::unique_ptr<CaptureAreaSelector> selector_;
+  std::map<QString, std::unique_ptr<ChangeDetector>> changeDetectors_;
+  QSet<QString> watchedKeys_;
+  std::unique_ptr<PdfDocument> document_;
+  Generation documentGeneration_{};
 };
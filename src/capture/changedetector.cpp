@@ -0,0 +1,121 @@
+#include "changedetector.h"
+#include "debug.h"
+
+#include <QImage>
+
+#include <cstdlib>
+
+namespace
+{
+const auto noiseThreshold = 6;  // difference of cell mean luminance
+const auto localChangeCells = ChangeDetector::gridSize *
+                              ChangeDetector::gridSize / 4;
+const auto activityRate = 0.2f;
+const auto animatedActivity = 0.5f;
+
+bool differs(uchar left, uchar right)
+{
+  return std::abs(int(left) - int(right)) > noiseThreshold;
+}
+}  // namespace
+
+bool ChangeDetector::isChanged(const QImage &image)
+{
+  auto current = signature(image);
+  if (current.size() != reference_.size()) {
+    reference_ = current;
+    last_ = std::move(current);
+    activity_.assign(reference_.size(), 0.f);
+    return true;
+  }
+
+  const auto size = current.size();
+  std::vector<bool> moved(size);
+  auto movedCount = 0;
+  for (size_t i = 0; i < size; ++i) {
+    moved[i] = differs(current[i], last_[i]);
+    movedCount += moved[i];
+  }
+
+  // large changes (new text, scrolling) must not be learned as animations
+  const auto isLocal = movedCount < localChangeCells;
+  auto changed = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (isLocal) {
+      activity_[i] *= 1.f - activityRate;
+      if (moved[i])
+        activity_[i] += activityRate;
+    }
+    if (activity_[i] > animatedActivity)
+      continue;
+    changed += differs(current[i], reference_[i]);
+  }
+
+  last_ = std::move(current);
+  if (changed == 0)
+    return false;
+
+  LTRACE() << "Watched area changed" << LARG(changed) << LARG(movedCount);
+  reference_ = last_;
+  return true;
+}
+
+void ChangeDetector::reset()
+{
+  reference_.clear();
+  last_.clear();
+  activity_.clear();
+}
+
+std::vector<uchar> ChangeDetector::signature(const QImage &image)
+{
+  std::vector<uchar> result;
+  if (image.isNull())
+    return result;
+
+  const auto source = image.format() == QImage::Format_RGB32 ||
+                              image.format() == QImage::Format_ARGB32
+                          ? image
+                          : image.convertToFormat(QImage::Format_RGB32);
+  const auto width = source.width();
+  const auto height = source.height();
+
+  std::vector<int> columns(gridSize + 1);
+  for (auto i = 0; i <= gridSize; ++i) columns[i] = i * width / gridSize;
+
+  // plain loops over contiguous rows, so compiler vectorizes them
+  std::vector<quint32> sums(gridSize * gridSize, 0);
+  std::vector<int> rows(gridSize, 0);
+  std::vector<quint16> luminance(size_t(width), 0);
+  for (auto y = 0; y < height; ++y) {
+    const auto row = reinterpret_cast<const quint32 *>(source.constScanLine(y));
+    for (auto x = 0; x < width; ++x) {
+      const auto pixel = row[x];
+      luminance[x] = quint16((((pixel >> 16) & 0xff) * 77 +
+                              ((pixel >> 8) & 0xff) * 150 +
+                              (pixel & 0xff) * 29) >>
+                             8);
+    }
+
+    const auto cellY = y * gridSize / height;
+    ++rows[cellY];
+    auto cells = &sums[size_t(cellY * gridSize)];
+    for (auto cell = 0; cell < gridSize; ++cell) {
+      auto sum = quint32(0);
+      for (auto x = columns[cell], end = columns[cell + 1]; x < end; ++x)
+        sum += luminance[x];
+      cells[cell] += sum;
+    }
+  }
+
+  result.resize(sums.size(), 0);
+  for (auto cellY = 0; cellY < gridSize; ++cellY) {
+    for (auto cellX = 0; cellX < gridSize; ++cellX) {
+      const auto count = rows[cellY] * (columns[cellX + 1] - columns[cellX]);
+      const auto index = size_t(cellY * gridSize + cellX);
+      if (count > 0)
+        result[index] = uchar(sums[index] / quint32(count));
+    }
+  }
+  return result;
+}
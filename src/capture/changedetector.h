@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <vector>
+
+class QImage;
+
+// Cheap check of periodically grabbed area for visible changes. The image is
+// reduced to a signature (mean luminance of every cell of a grid), that is
+// compared with the signature of the last changed frame. Cells that keep
+// changing locally (animations, blinking cursors) are learned and ignored.
+class ChangeDetector
+{
+public:
+  static const int gridSize = 32;
+
+  bool isChanged(const QImage& image);
+  void reset();
+
+  static std::vector<uchar> signature(const QImage& image);
+
+private:
+  std::vector<uchar> reference_;
+  std::vector<uchar> last_;
+  std::vector<float> activity_;
+};
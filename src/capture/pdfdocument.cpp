@@ -0,0 +1,159 @@
+#include "pdfdocument.h"
+#include "debug.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QObject>
+#include <QTextStream>
+
+#ifdef WITH_POPPLER
+#include <poppler-qt5.h>
+#else
+namespace Poppler
+{
+class Document
+{
+};
+}  // namespace Poppler
+#endif
+
+namespace
+{
+const auto maxPagesInWork = 4;  // 300 dpi A4 page takes ~35 MB
+const auto pageSeparator = QLatin1String("\n\f");
+}  // namespace
+
+PdfDocument::PdfDocument(const QString &fileName, int dpi,
+                         LayoutFormat layoutFormat)
+  : dpi_(dpi)
+  , layoutFormat_(layoutFormat)
+{
+  const QFileInfo info(fileName);
+  outputName_ = info.absolutePath() + QLatin1Char('/') +
+                info.completeBaseName() + QLatin1String(".txt");
+
+#ifdef WITH_POPPLER
+  document_.reset(Poppler::Document::load(fileName));
+  if (!document_ || document_->isLocked()) {
+    error_ = QObject::tr("Failed to open document: %1").arg(fileName);
+    document_.reset();
+    return;
+  }
+
+  document_->setRenderHint(Poppler::Document::Antialiasing);
+  document_->setRenderHint(Poppler::Document::TextAntialiasing);
+  pageCount_ = document_->numPages();
+  texts_.reserve(pageCount_);
+  for (auto i = 0; i < pageCount_; ++i) texts_.append(QString());
+  if (layoutFormat_ != LayoutFormat::None)
+    layouts_.resize(size_t(pageCount_));
+  LTRACE() << "Opened document" << fileName << LARG(pageCount_)
+           << LARG(dpi_);
+#else
+  error_ = QObject::tr("PDF documents are not supported by this build");
+#endif
+}
+
+PdfDocument::~PdfDocument() = default;
+
+const QString &PdfDocument::error() const
+{
+  return error_;
+}
+
+const QString &PdfDocument::outputName() const
+{
+  return outputName_;
+}
+
+int PdfDocument::pageCount() const
+{
+  return pageCount_;
+}
+
+bool PdfDocument::canRenderPage() const
+{
+  return document_ && nextPage_ < pageCount_ &&
+         nextPage_ - finishedPages_ < maxPagesInWork;
+}
+
+bool PdfDocument::isFinished() const
+{
+  return finishedPages_ >= pageCount_;
+}
+
+QImage PdfDocument::renderPage(int &page)
+{
+  SOFT_ASSERT(canRenderPage(), return {});
+  page = nextPage_++;
+
+#ifdef WITH_POPPLER
+  std::unique_ptr<Poppler::Page> source(document_->page(page));
+  if (!source) {
+    LTRACE() << "Failed to load page" << LARG(page);
+    return {};
+  }
+  return source->renderToImage(dpi_, dpi_);
+#else
+  return {};
+#endif
+}
+
+void PdfDocument::setText(int page, const QString &text,
+                          const TextLayout &layout)
+{
+  SOFT_ASSERT(page >= 0 && page < pageCount_, return );
+  texts_[page] = text;
+  if (!layouts_.empty())
+    layouts_[page] = layout;
+  ++finishedPages_;
+}
+
+bool PdfDocument::write()
+{
+  SOFT_ASSERT(isFinished(), return false);
+
+  QFile file(outputName_);
+  if (!file.open(QFile::WriteOnly | QFile::Text)) {
+    error_ = QObject::tr("Failed to write recognized text: %1")
+                 .arg(file.errorString());
+    return false;
+  }
+
+  QTextStream stream(&file);
+  stream.setCodec("UTF-8");
+  stream << texts_.join(pageSeparator) << '\n';
+
+  if (layouts_.empty())
+    return true;
+
+  const QFileInfo info(outputName_);
+  QFile layoutFile(info.absolutePath() + QLatin1Char('/') +
+                   info.completeBaseName() +
+                   TextLayout::fileExtension(layoutFormat_));
+  if (!layoutFile.open(QFile::WriteOnly | QFile::Text)) {
+    error_ = QObject::tr("Failed to write text layout: %1")
+                 .arg(layoutFile.errorString());
+    return false;
+  }
+
+  QTextStream layoutStream(&layoutFile);
+  layoutStream.setCodec("UTF-8");
+  layoutStream << TextLayout::toString(layoutFormat_, layouts_);
+  return true;
+}
+
+bool PdfDocument::isSupported()
+{
+#ifdef WITH_POPPLER
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool PdfDocument::isDocument(const QString &fileName)
+{
+  return fileName.endsWith(QLatin1String(".pdf"), Qt::CaseInsensitive);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "textlayout.h"
+
+#include <QStringList>
+
+#include <memory>
+
+class QImage;
+namespace Poppler
+{
+class Document;
+}
+
+// PDF file, recognized page by page. Pages are rendered only when there is a
+// free slot in work, so just a few rendered pages are kept in memory while
+// recognizer processes them in parallel. Recognized texts are collected in
+// page order and written to text file next to the document, along with
+// optional layout file.
+class PdfDocument
+{
+public:
+  PdfDocument(const QString &fileName, int dpi,
+              LayoutFormat layoutFormat = LayoutFormat::None);
+  ~PdfDocument();
+
+  const QString &error() const;
+  const QString &outputName() const;
+  int pageCount() const;
+  bool canRenderPage() const;
+  bool isFinished() const;
+
+  // Renders next page and sets its index.
+  QImage renderPage(int &page);
+  void setText(int page, const QString &text, const TextLayout &layout);
+  bool write();
+
+  static bool isSupported();
+  static bool isDocument(const QString &fileName);
+
+private:
+  std::unique_ptr<Poppler::Document> document_;
+  QString error_;
+  QString outputName_;
+  int dpi_;
+  LayoutFormat layoutFormat_;
+  int pageCount_{0};
+  int nextPage_{0};
+  int finishedPages_{0};
+  QStringList texts_;
+  std::vector<TextLayout> layouts_;
+};
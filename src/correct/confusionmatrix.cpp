@@ -0,0 +1,185 @@
+#include "confusionmatrix.h"
+
+#include <QRegularExpression>
+
+namespace
+{
+const auto builtinCost = 0.3;
+const auto learnedCost = 0.25;
+const auto minCost = 0.05;
+const auto relearnFactor = 0.8;
+
+struct Confusion {
+  const char* recognized;
+  const char* actual;
+};
+
+const Confusion builtinConfusions[] = {
+    {"rn", "m"}, {"m", "rn"}, {"cl", "d"}, {"d", "cl"}, {"vv", "w"},
+    {"w", "vv"}, {"li", "h"}, {"ii", "u"}, {"nn", "m"}, {"0", "O"},
+    {"O", "0"},  {"0", "o"},  {"o", "0"},  {"1", "l"},  {"l", "1"},
+    {"1", "I"},  {"I", "1"},  {"l", "I"},  {"I", "l"},  {"|", "l"},
+    {"|", "I"},  {"5", "S"},  {"S", "5"},  {"8", "B"},  {"B", "8"},
+    {"6", "b"},  {"9", "g"},  {"c", "e"},  {"e", "c"},  {"u", "n"},
+    {"n", "u"},  {"ﬁ", "fi"}, {"ﬂ", "fl"},
+};
+}  // namespace
+
+ConfusionMatrix::ConfusionMatrix()
+{
+  for (const auto& i : builtinConfusions)
+    add(QString::fromUtf8(i.recognized), QString::fromUtf8(i.actual),
+        builtinCost);
+}
+
+void ConfusionMatrix::add(const QString& recognized, const QString& actual,
+                          double cost)
+{
+  if (recognized.isEmpty() || recognized == actual)
+    return;
+  if (recognized.size() > maxGramLength || actual.size() > maxGramLength)
+    return;
+
+  auto& rules = rules_[recognized];
+  for (auto& rule : rules) {
+    if (rule.actual != actual)
+      continue;
+    rule.cost = std::min(rule.cost, cost);
+    return;
+  }
+  rules.push_back({actual, cost});
+}
+
+void ConfusionMatrix::learn(const QString& recognized,
+                            const QString& corrected)
+{
+  const QRegularExpression separator(QStringLiteral("\\s+"));
+  const auto recognizedWords =
+      recognized.split(separator, QString::SkipEmptyParts);
+  const auto correctedWords =
+      corrected.split(separator, QString::SkipEmptyParts);
+
+  if (recognizedWords.size() != correctedWords.size()) {
+    learnWord(recognized, corrected);
+    return;
+  }
+
+  for (auto i = 0, end = recognizedWords.size(); i < end; ++i)
+    learnWord(recognizedWords[i], correctedWords[i]);
+}
+
+void ConfusionMatrix::learnWord(const QString& recognized,
+                                const QString& corrected)
+{
+  if (recognized == corrected)
+    return;
+
+  auto prefix = 0;
+  const auto maxPrefix = std::min(recognized.size(), corrected.size());
+  while (prefix < maxPrefix && recognized[prefix] == corrected[prefix])
+    ++prefix;
+
+  auto suffix = 0;
+  const auto maxSuffix = maxPrefix - prefix;
+  while (suffix < maxSuffix &&
+         recognized[recognized.size() - 1 - suffix] ==
+             corrected[corrected.size() - 1 - suffix])
+    ++suffix;
+
+  const auto from = recognized.mid(prefix, recognized.size() - prefix - suffix);
+  const auto to = corrected.mid(prefix, corrected.size() - prefix - suffix);
+  if (from.isEmpty() || from.size() > maxGramLength ||
+      to.size() > maxGramLength)
+    return;
+
+  auto& rules = rules_[from];
+  for (auto& rule : rules) {
+    if (rule.actual != to)
+      continue;
+    rule.cost = std::max(std::min(rule.cost, learnedCost) * relearnFactor,
+                         minCost);
+    return;
+  }
+  rules.push_back({to, learnedCost});
+}
+
+double ConfusionMatrix::distance(const QString& recognized,
+                                 const QString& actual) const
+{
+  if (recognized == actual)
+    return 0;
+
+  const auto rows = recognized.size();
+  const auto columns = actual.size();
+  if (rows == 0)
+    return columns;
+  if (columns == 0)
+    return rows;
+
+  // Full (rows+1)x(columns+1) matrix in one block, because n-gram rules look
+  // back more than one row/column.
+  const auto width = columns + 1;
+  std::vector<double> cells(size_t((rows + 1) * width));
+  for (auto j = 0; j < width; ++j) cells[j] = j;
+
+  const auto source = recognized.constData();
+  const auto target = actual.constData();
+  std::vector<std::pair<int, const Rule*>> matching;
+
+  for (auto i = 1; i <= rows; ++i) {
+    auto* row = &cells[size_t(i * width)];
+    const auto* previous = row - width;
+    const auto sourceChar = source[i - 1];
+
+    // deletions and substitutions do not depend on the current row,
+    // so this loop can be vectorized
+    row[0] = i;
+    for (auto j = 1; j < width; ++j) {
+      const auto substitution =
+          previous[j - 1] + (sourceChar == target[j - 1] ? 0.0 : 1.0);
+      row[j] = std::min(previous[j] + 1.0, substitution);
+    }
+
+    matching.clear();
+    for (auto length = 1; length <= std::min(i, int(maxGramLength));
+         ++length) {
+      const auto it = rules_.constFind(recognized.mid(i - length, length));
+      if (it == rules_.cend())
+        continue;
+      for (const auto& rule : it.value()) matching.emplace_back(length, &rule);
+    }
+
+    // rules with empty replacement end at column 0 too
+    for (const auto& match : matching) {
+      if (!match.second->actual.isEmpty())
+        continue;
+      const auto origin = cells[size_t((i - match.first) * width)];
+      row[0] = std::min(row[0], origin + match.second->cost);
+    }
+
+    for (auto j = 1; j < width; ++j) {
+      auto best = std::min(row[j], row[j - 1] + 1.0);
+
+      for (const auto& match : matching) {
+        const auto& ruleTarget = match.second->actual;
+        const auto targetLength = ruleTarget.size();
+        if (targetLength > j)
+          continue;
+        if (QStringRef(&actual, j - targetLength, targetLength) != ruleTarget)
+          continue;
+        const auto origin = cells[size_t((i - match.first) * width + j -
+                                         targetLength)];
+        best = std::min(best, origin + match.second->cost);
+      }
+
+      row[j] = best;
+    }
+  }
+
+  return cells.back();
+}
+
+bool ConfusionMatrix::isEmpty() const
+{
+  return rules_.isEmpty();
+}
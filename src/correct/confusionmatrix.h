@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+// Weighted substitutions of character n-grams typical for OCR output
+// (e.g. "rn" recognized instead of "m").
+class ConfusionMatrix
+{
+public:
+  ConfusionMatrix();
+
+  void add(const QString& recognized, const QString& actual, double cost);
+  void learn(const QString& recognized, const QString& corrected);
+
+  double distance(const QString& recognized, const QString& actual) const;
+  bool isEmpty() const;
+
+  static const int maxGramLength = 3;
+
+private:
+  struct Rule {
+    QString actual;
+    double cost;
+  };
+  void learnWord(const QString& recognized, const QString& corrected);
+
+  QHash<QString, std::vector<Rule>> rules_;
+};
+
+using ConfusionMatrixPtr = std::shared_ptr<const ConfusionMatrix>;
+
+Q_DECLARE_METATYPE(ConfusionMatrixPtr);
@@ -1,23 +1,35 @@
 #include "corrector.h"
 #include "correctorworker.h"
 #include "debug.h"
-#include "languagecodes.h"
 #include "manager.h"
 #include "settings.h"
 #include "task.h"
 
 #include <QThread>
+#include <QTimer>
+
+#include <algorithm>
 
 Corrector::Corrector(Manager &manager, const Settings &settings)
   : manager_(manager)
   , settings_(settings)
   , workerThread_(new QThread(this))
 {
+  qRegisterMetaType<ConfusionMatrixPtr>();
+  qRegisterMetaType<UserSubstitutionsPtr>();
+  qRegisterMetaType<service::ThreadPolicy>();
+
   auto worker = new CorrectorWorker;
   connect(this, &Corrector::resetAuto,  //
           worker, &CorrectorWorker::reset);
   connect(this, &Corrector::correctAuto,  //
           worker, &CorrectorWorker::handle);
+  connect(this, &Corrector::updateConfusions,  //
+          worker, &CorrectorWorker::setConfusions);
+  connect(this, &Corrector::updateSubstitutions,  //
+          worker, &CorrectorWorker::setSubstitutions);
+  connect(this, &Corrector::updatePolicy,  //
+          worker, &service::ThreadScheduling::apply);
   connect(worker, &CorrectorWorker::finished,  //
           this, &Corrector::finishCorrection);
   connect(workerThread_, &QThread::finished,  //
@@ -42,7 +54,7 @@ void Corrector::correct(const TaskPtr &task)
   SOFT_ASSERT(task, return );
   SOFT_ASSERT(task->isValid(), return );
 
-  queue_.push_back(task);
+  order_.add(task);
 
   if (task->recognized.isEmpty()) {
     finishCorrection(task);
@@ -51,16 +63,21 @@ void Corrector::correct(const TaskPtr &task)
 
   task->corrected = task->recognized;
 
-  if (!settings_.userSubstitutions.empty()) {
-    task->corrected = substituteUser(task->recognized, task->sourceLanguage);
+  // alternatives of n-gram rescoring are found by recognized words, so
+  // worker applies user substitutions after it
+  const auto isSubstituted = substitutions_ && !substitutions_->isEmpty();
+  if (isSubstituted && !task->useLanguageModel) {
+    task->corrected =
+        substitutions_->apply(task->recognized, task->sourceLanguage);
     LTRACE() << "Corrected with user data";
   }
 
-  if (!task->useHunspell) {
+  if (!task->useHunspell && !task->useLanguageModel) {
     finishCorrection(task);
     return;
   }
 
+  queue_.push_back(task);
   if (queue_.size() == 1)
     processQueue();
 }
@@ -74,69 +91,96 @@ void Corrector::processQueue()
 
 void Corrector::updateSettings()
 {
+  // running task is passed further when worker reports it, waiting ones are
+  // canceled and finished ones are not delayed by the order anymore
+  const auto running = queue_.empty() ? TaskPtr() : queue_.front();
+  std::vector<TaskPtr> dropped;
+  for (const auto &task : order_.clear()) {
+    if (task == running)
+      continue;
+    if (std::find(queue_.cbegin(), queue_.cend(), task) != queue_.cend())
+      task->error = tr("Correction canceled by changed settings");
+    dropped.push_back(task);
+  }
   queue_.clear();
-  emit resetAuto(settings_.hunspellDir);
+  if (running)
+    queue_.push_back(running);
+
+  // pass them after all processing settings are applied
+  QTimer::singleShot(0, this, [this, dropped] {
+    for (const auto &task : dropped) manager_.corrected(task);
+  });
+
+  emit resetAuto(settings_.hunspellDir, settings_.languageModelsDir);
+  compileSubstitutions();
+  rebuildConfusions();
+
+  service::ThreadPolicy policy;
+  policy.isBackground = settings_.lowPriorityWorkers;
+  policy.avoidFirstCore = settings_.keepFirstCoreFree;
+  policy.maxThreads = 1;
+  emit updatePolicy(policy);
 }
 
-void Corrector::finishCorrection(const TaskPtr &task)
+void Corrector::learn(const QString &recognized, const QString &corrected)
 {
-  manager_.corrected(task);
+  if (recognized.isEmpty() || recognized == corrected)
+    return;
 
-  SOFT_ASSERT(!queue_.empty(), return );
-  if (queue_.front() == task) {
-    queue_.pop_front();
-  } else {
-    LERROR() << "processed not first item in correction queue";
-    queue_.clear();
-  }
-  processQueue();
+  const auto maxLearned = 1000;
+  if (learnedEdits_.size() >= maxLearned)
+    learnedEdits_.erase(learnedEdits_.begin());
+  learnedEdits_.emplace_back(recognized, corrected);
+  rebuildConfusions();
 }
 
-QString Corrector::substituteUser(const QString &source,
-                                  const LanguageId &language) const
+void Corrector::rebuildConfusions()
 {
-  auto result = source;
+  auto confusions = std::make_shared<ConfusionMatrix>();
 
-  using It = Substitutions::const_iterator;
-  std::vector<std::pair<It, It>> ranges;
-
-  {
-    const auto range = settings_.userSubstitutions.equal_range(language);
-    if (range.first != settings_.userSubstitutions.cend())
-      ranges.push_back(range);
-  }
-  {
-    const auto anyId = LanguageCodes::anyLanguageId();
-    const auto range = settings_.userSubstitutions.equal_range(anyId);
-    if (range.first != settings_.userSubstitutions.cend())
-      ranges.push_back(range);
+  if (settings_.useUserSubstitutions) {
+    for (const auto &i : settings_.userSubstitutions) {
+      if (i.second.type != SubstitutionType::Regex)
+        confusions->learn(i.second.source, i.second.target);
+    }
   }
 
-  if (ranges.empty())
-    return result;
-
-  while (true) {
-    auto bestMatch = ranges.front().first;
-    auto bestMatchLen = 0;
-
-    for (const auto &range : ranges) {
-      for (auto it = range.first; it != range.second; ++it) {
-        const auto &sub = it->second;
-        if (!result.contains(sub.source))
-          continue;
-        const auto len = sub.source.length();
-        if (len > bestMatchLen) {
-          bestMatchLen = len;
-          bestMatch = it;
-        }
-      }
-    }
+  for (const auto &edit : learnedEdits_)
+    confusions->learn(edit.first, edit.second);
+
+  LTRACE() << "Rebuilt OCR confusions" << LARG(learnedEdits_.size());
+  emit updateConfusions(confusions);
+}
 
-    if (bestMatchLen < 1)
-      break;
+void Corrector::finishCorrection(const TaskPtr &task)
+{
+  auto isRunning = false;
+  if (const auto it = std::find(queue_.begin(), queue_.end(), task);
+      it != queue_.end()) {
+    isRunning = it == queue_.begin();
+    queue_.erase(it);
+  }
 
-    result.replace(bestMatch->second.source, bestMatch->second.target);
+  if (!order_.contains(task)) {
+    LTRACE() << "Correction finished after queue was cleared";
+    manager_.corrected(task);
+  } else {
+    // keep order of areas of one capture, other captures are not delayed
+    for (const auto &finished : order_.finish(task))
+      manager_.corrected(finished);
   }
 
-  return result;
+  if (isRunning)
+    processQueue();
+}
+
+void Corrector::compileSubstitutions()
+{
+  substitutions_ =
+      std::make_shared<UserSubstitutions>(settings_.userSubstitutions);
+  for (const auto &error : substitutions_->errors()) LWARNING() << error;
+
+  // worker applies them after n-gram rescoring, in its own instance
+  emit updateSubstitutions(
+      std::make_shared<UserSubstitutions>(settings_.userSubstitutions));
 }
@@ -2,6 +2,11 @@
 
 #include "stfwd.h"
 
+#include "confusionmatrix.h"
+#include "taskorder.h"
+#include "threadscheduling.h"
+#include "usersubstitutions.h"
+
 #include <QObject>
 
 #include <deque>
@@ -15,19 +20,26 @@ public:
 
   void correct(const TaskPtr &task);
   void updateSettings();
+  void learn(const QString &recognized, const QString &corrected);
 
 signals:
   void correctAuto(const TaskPtr &task);
-  void resetAuto(const QString &tessdataPath);
+  void resetAuto(const QString &hunspellDir, const QString &languageModelsDir);
+  void updateConfusions(const ConfusionMatrixPtr &confusions);
+  void updateSubstitutions(const UserSubstitutionsPtr &substitutions);
+  void updatePolicy(const service::ThreadPolicy &policy);
 
 private:
   void finishCorrection(const TaskPtr &task);
-  QString substituteUser(const QString &source,
-                         const LanguageId &language) const;
   void processQueue();
+  void rebuildConfusions();
+  void compileSubstitutions();
 
   Manager &manager_;
   const Settings &settings_;
   QThread *workerThread_;
-  std::deque<TaskPtr> queue_;
+  std::deque<TaskPtr> queue_;  // for worker, first one is running
+  TaskOrder order_;
+  std::vector<std::pair<QString, QString>> learnedEdits_;
+  UserSubstitutionsPtr substitutions_;
 };
@@ -1,9 +1,13 @@
 #include "correctorworker.h"
 #include "debug.h"
 #include "hunspellcorrector.h"
+#include "ngramcorrector.h"
 #include "task.h"
 
-CorrectorWorker::CorrectorWorker() = default;
+CorrectorWorker::CorrectorWorker()
+  : confusions_(std::make_shared<ConfusionMatrix>())
+{
+}
 
 CorrectorWorker::~CorrectorWorker() = default;
 
@@ -13,29 +17,56 @@ void CorrectorWorker::handle(const TaskPtr &task)
   SOFT_ASSERT(task->isValid(), return );
   SOFT_ASSERT(!hunspellDir_.isEmpty(), return );
 
-  LTRACE() << "Start hunspell correction" << task->sourceLanguage;
+  LTRACE() << "Start automatic correction" << task->sourceLanguage;
   auto result = task;
 
-  if (!bundles_.count(task->sourceLanguage)) {
+  auto &bundle = bundles_[task->sourceLanguage];
+
+  if (task->useHunspell && !bundle.hunspell) {
     LTRACE() << "Create hunspell engine" << task->sourceLanguage;
     auto engine =
         std::make_unique<HunspellCorrector>(task->sourceLanguage, hunspellDir_);
 
-    if (!engine->isValid()) {
+    if (engine->isValid()) {
+      bundle.hunspell = std::move(engine);
+      LTRACE() << "Added hunspell engine" << task->sourceLanguage;
+    } else {
       LWARNING()
           << tr("Failed to init hunspell engine: %1").arg(engine->error());
-      emit finished(result);
-      return;
     }
+  }
 
-    bundles_.emplace(task->sourceLanguage, Bundle{std::move(engine), 0});
-    LTRACE() << "Added hunspell engine" << task->sourceLanguage;
+  if (task->useLanguageModel && !bundle.ngram) {
+    LTRACE() << "Create n-gram corrector" << task->sourceLanguage;
+    auto engine = std::make_unique<NgramCorrector>(task->sourceLanguage,
+                                                   languageModelsDir_);
+
+    if (engine->isValid()) {
+      bundle.ngram = std::move(engine);
+      LTRACE() << "Added n-gram corrector" << task->sourceLanguage;
+    } else {
+      LWARNING()
+          << tr("Failed to init language model: %1").arg(engine->error());
+    }
   }
 
-  auto &bundle = bundles_[task->sourceLanguage];
-  SOFT_ASSERT(bundle.hunspell->isValid(), return );
+  // rescoring goes first, while words match keys of their alternatives
+  if (task->useLanguageModel && bundle.ngram) {
+    result->corrected =
+        bundle.ngram->correct(result->corrected, task->wordAlternatives);
+  }
 
-  result->corrected = bundle.hunspell->correct(task->corrected);
+  if (task->useLanguageModel && substitutions_ && !substitutions_->isEmpty()) {
+    result->corrected =
+        substitutions_->apply(result->corrected, task->sourceLanguage);
+    LTRACE() << "Corrected with user data";
+  }
+
+  if (task->useHunspell && bundle.hunspell) {
+    SOFT_ASSERT(confusions_, return );
+    result->corrected =
+        bundle.hunspell->correct(result->corrected, *confusions_);
+  }
 
   const auto keepGenerations = 10;
   bundle.usesLeft = keepGenerations;
@@ -45,14 +76,31 @@ void CorrectorWorker::handle(const TaskPtr &task)
   emit finished(result);
 }
 
-void CorrectorWorker::reset(const QString &hunspellDir)
+void CorrectorWorker::reset(const QString &hunspellDir,
+                            const QString &languageModelsDir)
 {
-  if (hunspellDir_ == hunspellDir)
+  if (hunspellDir_ == hunspellDir && languageModelsDir_ == languageModelsDir)
     return;
 
   hunspellDir_ = hunspellDir;
+  languageModelsDir_ = languageModelsDir;
   bundles_.clear();
-  LTRACE() << "Cleared hunspell engines";
+  LTRACE() << "Cleared correction engines";
+}
+
+void CorrectorWorker::setConfusions(const ConfusionMatrixPtr &confusions)
+{
+  SOFT_ASSERT(confusions, return );
+  confusions_ = confusions;
+  LTRACE() << "Updated OCR confusions";
+}
+
+void CorrectorWorker::setSubstitutions(
+    const UserSubstitutionsPtr &substitutions)
+{
+  SOFT_ASSERT(substitutions, return );
+  substitutions_ = substitutions;
+  LTRACE() << "Updated user substitutions";
 }
 
 void CorrectorWorker::removeUnused(Generation current)
@@ -66,7 +114,7 @@ void CorrectorWorker::removeUnused(Generation current)
     } else {
       const auto name = it->first;
       it = bundles_.erase(it);
-      LTRACE() << "Removed unused hunspell engine" << name;
+      LTRACE() << "Removed unused correction engines" << name;
     }
   }
 }
@@ -2,9 +2,13 @@
 
 #include "stfwd.h"
 
+#include "confusionmatrix.h"
+#include "usersubstitutions.h"
+
 #include <QObject>
 
 class HunspellCorrector;
+class NgramCorrector;
 
 class CorrectorWorker : public QObject
 {
@@ -14,7 +18,9 @@ public:
   ~CorrectorWorker();
 
   void handle(const TaskPtr &task);
-  void reset(const QString &hunspellDir);
+  void reset(const QString &hunspellDir, const QString &languageModelsDir);
+  void setConfusions(const ConfusionMatrixPtr &confusions);
+  void setSubstitutions(const UserSubstitutionsPtr &substitutions);
 
 signals:
   void finished(const TaskPtr &task);
@@ -22,6 +28,7 @@ signals:
 private:
   struct Bundle {
     std::unique_ptr<HunspellCorrector> hunspell;
+    std::unique_ptr<NgramCorrector> ngram;
     int usesLeft;
   };
   void removeUnused(Generation current);
@@ -29,4 +36,7 @@ private:
   std::map<QString, Bundle> bundles_;
   Generation lastGeneration_{};
   QString hunspellDir_;
+  QString languageModelsDir_;
+  ConfusionMatrixPtr confusions_;
+  UserSubstitutionsPtr substitutions_;  // used only by this thread
 };
@@ -1,4 +1,5 @@
 #include "hunspellcorrector.h"
+#include "confusionmatrix.h"
 #include "debug.h"
 #include "languagecodes.h"
 #include "settings.h"
@@ -9,41 +10,6 @@
 #include <QRegularExpression>
 #include <QTextCodec>
 
-static int levenshteinDistance(const QString &source, const QString &target)
-{
-  if (source == target)
-    return 0;
-
-  const auto sourceCount = source.size();
-  const auto targetCount = target.size();
-
-  if (sourceCount == 0)
-    return targetCount;
-
-  if (targetCount == 0)
-    return sourceCount;
-
-  if (sourceCount > targetCount)
-    return levenshteinDistance(target, source);
-
-  QVector<int> previousColumn;
-  previousColumn.reserve(targetCount + 1);
-  for (auto i = 0; i < targetCount + 1; ++i) previousColumn.append(i);
-
-  QVector<int> column(targetCount + 1, 0);
-  for (auto i = 0; i < sourceCount; ++i) {
-    column[0] = i + 1;
-    for (auto j = 0; j < targetCount; ++j) {
-      column[j + 1] = std::min(
-          {1 + column.at(j), 1 + previousColumn.at(1 + j),
-           previousColumn.at(j) + ((source.at(i) == target.at(j)) ? 0 : 1)});
-    }
-    column.swap(previousColumn);
-  }
-
-  return previousColumn.at(targetCount);
-}
-
 HunspellCorrector::HunspellCorrector(const LanguageId &language,
                                      const QString &dictPath)
 {
@@ -102,7 +68,8 @@ void HunspellCorrector::init(const QString &path)
   }
 }
 
-QString HunspellCorrector::correct(const QString &original)
+QString HunspellCorrector::correct(const QString &original,
+                                   const ConfusionMatrix &confusions)
 {
   SOFT_ASSERT(engine_, return original);
 
@@ -118,7 +85,7 @@ QString HunspellCorrector::correct(const QString &original)
     const auto ch = original[i];
     if (ch.isPunct() || ch.isSpace()) {
       if (!word.isEmpty()) {
-        correctWord(word, *codec);
+        correctWord(word, *codec, confusions);
         result += word;
         word.clear();
       }
@@ -139,7 +106,7 @@ QString HunspellCorrector::correct(const QString &original)
   }
 
   if (!word.isEmpty()) {
-    correctWord(word, *codec);
+    correctWord(word, *codec, confusions);
     result += word;
   }
   result += separator;
@@ -147,7 +114,8 @@ QString HunspellCorrector::correct(const QString &original)
   return result;
 }
 
-void HunspellCorrector::correctWord(QString &word, QTextCodec &codec) const
+void HunspellCorrector::correctWord(QString &word, QTextCodec &codec,
+                                    const ConfusionMatrix &confusions) const
 {
   if (word.isEmpty())
     return;
@@ -160,12 +128,21 @@ void HunspellCorrector::correctWord(QString &word, QTextCodec &codec) const
   if (suggestions.empty())
     return;
 
-  const auto suggestion = QByteArray::fromStdString(suggestions.front());
-  const auto distance = levenshteinDistance(word, suggestion);
-  const auto maxDistance = std::max(int(word.size() * 0.2), 1);
-  LTRACE() << "hunspell" << word << suggestion << "distances" << distance
+  QString best;
+  auto bestDistance = std::numeric_limits<double>::max();
+  for (const auto &suggestion : suggestions) {
+    const auto candidate = codec.toUnicode(suggestion.c_str());
+    const auto distance = confusions.distance(word, candidate);
+    if (distance >= bestDistance)
+      continue;
+    best = candidate;
+    bestDistance = distance;
+  }
+
+  const auto maxDistance = std::max(word.size() * 0.2, 1.0);
+  LTRACE() << "hunspell" << word << best << "distances" << bestDistance
            << maxDistance;
 
-  if (distance <= maxDistance)
-    word = suggestion;
+  if (bestDistance <= maxDistance)
+    word = best;
 }
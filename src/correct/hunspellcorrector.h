@@ -5,6 +5,7 @@
 #include <QString>
 
 class Hunspell;
+class ConfusionMatrix;
 
 class HunspellCorrector
 {
@@ -15,11 +16,12 @@ public:
 
   const QString& error() const;
   bool isValid() const;
-  QString correct(const QString& original);
+  QString correct(const QString& original, const ConfusionMatrix& confusions);
 
 private:
   void init(const QString& path);
-  void correctWord(QString& word, QTextCodec& codec) const;
+  void correctWord(QString& word, QTextCodec& codec,
+                   const ConfusionMatrix& confusions) const;
 
   std::unique_ptr<Hunspell> engine_;
   QString error_;
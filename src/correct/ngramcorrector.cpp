@@ -0,0 +1,149 @@
+#include "ngramcorrector.h"
+#include "debug.h"
+#include "languagecodes.h"
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+const auto maxCandidates = 6;
+const auto originalBonus = 0.5;  // log10, prefer recognized word on ties
+}  // namespace
+
+NgramCorrector::NgramCorrector(const LanguageId &language,
+                               const QString &modelsDir)
+{
+  const auto name = LanguageCodes::iso639_1(language);
+  const auto fileName =
+      modelsDir + QLatin1Char('/') + name + QLatin1String(".stlm");
+  model_ = NgramModel::load(fileName, error_);
+}
+
+NgramCorrector::~NgramCorrector() = default;
+
+const QString &NgramCorrector::error() const
+{
+  return error_;
+}
+
+bool NgramCorrector::isValid() const
+{
+  return model_.get();
+}
+
+QString NgramCorrector::correct(const QString &original,
+                                const WordAlternatives &alternatives) const
+{
+  SOFT_ASSERT(model_, return original);
+
+  if (alternatives.isEmpty())
+    return original;
+
+  auto lines = original.split(QLatin1Char('\n'));
+  QElapsedTimer timer;
+  for (auto &line : lines) {
+    timer.start();
+    line = correctLine(line, alternatives);
+    LTRACE() << "n-gram rescoring of line took" << timer.nsecsElapsed() / 1000
+             << "us" << LARG(line.size());
+  }
+  return lines.join(QLatin1Char('\n'));
+}
+
+QString NgramCorrector::correctLine(const QString &line,
+                                    const WordAlternatives &alternatives) const
+{
+  static const QRegularExpression wordExpression(QStringLiteral("[\\w']+"));
+
+  struct Word {
+    int start;
+    int length;
+    QStringList candidates;
+  };
+  std::vector<Word> words;
+  auto hasAlternatives = false;
+
+  auto it = wordExpression.globalMatch(line);
+  while (it.hasNext()) {
+    const auto match = it.next();
+    Word word{match.capturedStart(), match.capturedLength(),
+              QStringList{match.captured()}};
+    for (const auto &alternative : alternatives.value(match.captured())) {
+      if (word.candidates.size() >= maxCandidates)
+        break;
+      if (!word.candidates.contains(alternative))
+        word.candidates.append(alternative);
+    }
+    hasAlternatives |= word.candidates.size() > 1;
+    words.push_back(std::move(word));
+  }
+
+  if (!hasAlternatives)
+    return line;
+
+  // viterbi over candidates, state is the choice for the previous word
+  struct Node {
+    double score;
+    int back;
+  };
+  std::vector<std::vector<Node>> layers(words.size());
+
+  for (size_t i = 0, end = words.size(); i < end; ++i) {
+    const auto &candidates = words[i].candidates;
+    auto &layer = layers[i];
+    const auto lowest = std::numeric_limits<double>::lowest();
+    layer.resize(size_t(candidates.size()), {lowest, -1});
+
+    for (auto c = 0, cEnd = candidates.size(); c < cEnd; ++c) {
+      const auto bonus = c == 0 ? originalBonus : 0.0;
+
+      if (i == 0) {
+        layer[c].score = model_->score({}, candidates[c]) + bonus;
+        continue;
+      }
+
+      const auto &previous = layers[i - 1];
+      const auto &previousCandidates = words[i - 1].candidates;
+      for (auto p = 0, pEnd = previousCandidates.size(); p < pEnd; ++p) {
+        QStringList context;
+        if (i > 1 && previous[p].back >= 0)
+          context.append(words[i - 2].candidates[previous[p].back]);
+        context.append(previousCandidates[p]);
+
+        const auto score =
+            previous[p].score + model_->score(context, candidates[c]) + bonus;
+        if (score <= layer[c].score)
+          continue;
+        layer[c] = {score, p};
+      }
+    }
+  }
+
+  std::vector<int> choices(words.size(), 0);
+  {
+    const auto &last = layers.back();
+    auto best = std::max_element(
+        last.cbegin(), last.cend(),
+        [](const Node &l, const Node &r) { return l.score < r.score; });
+    auto choice = int(best - last.cbegin());
+    for (auto i = int(words.size()) - 1; i >= 0; --i) {
+      choices[i] = choice;
+      choice = layers[i][choice].back;
+    }
+  }
+
+  auto result = line;
+  for (auto i = int(words.size()) - 1; i >= 0; --i) {
+    if (choices[i] == 0)
+      continue;
+    const auto &word = words[i];
+    const auto &replacement = word.candidates[choices[i]];
+    LTRACE() << "n-gram replaced" << word.candidates.first() << replacement;
+    result.replace(word.start, word.length, replacement);
+  }
+  return result;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ngrammodel.h"
+#include "stfwd.h"
+
+#include <QHash>
+
+using WordAlternatives = QHash<QString, QStringList>;
+
+class NgramCorrector
+{
+public:
+  NgramCorrector(const LanguageId& language, const QString& modelsDir);
+  ~NgramCorrector();
+
+  const QString& error() const;
+  bool isValid() const;
+  QString correct(const QString& original,
+                  const WordAlternatives& alternatives) const;
+
+private:
+  QString correctLine(const QString& line,
+                      const WordAlternatives& alternatives) const;
+
+  NgramModelPtr model_;
+  QString error_;
+};
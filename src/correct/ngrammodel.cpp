@@ -0,0 +1,132 @@
+#include "ngrammodel.h"
+#include "debug.h"
+
+#include <QMutex>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace
+{
+const char magic[] = {'S', 'T', 'L', 'M'};
+const quint32 supportedVersion = 1;
+const auto quantizationLevels = 256;
+
+quint64 hashNgram(const QStringList& words)
+{
+  const auto data = words.join(QLatin1Char(' ')).toLower().toUtf8();
+  quint64 hash = 14695981039346656037ull;
+  for (const auto byte : data) {
+    hash ^= quint8(byte);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+}  // namespace
+
+struct NgramModel::Header {
+  char magic[4];
+  quint32 version;
+  quint32 order;
+  quint32 count;
+  float unknownLogProb;
+  float backoffPenalty;
+  float quantization[quantizationLevels];
+};
+
+NgramModel::~NgramModel() = default;
+
+NgramModelPtr NgramModel::load(const QString& fileName, QString& error)
+{
+  static QMutex mutex;
+  static std::map<QString, std::weak_ptr<const NgramModel>> loaded;
+
+  QMutexLocker locker(&mutex);
+  if (auto existing = loaded[fileName].lock())
+    return existing;
+
+  std::shared_ptr<NgramModel> model(new NgramModel);
+  if (!model->init(fileName, error))
+    return {};
+
+  loaded[fileName] = model;
+  LTRACE() << "Loaded n-gram model" << fileName << LARG(model->order());
+  return model;
+}
+
+bool NgramModel::init(const QString& fileName, QString& error)
+{
+  file_.setFileName(fileName);
+  if (!file_.open(QFile::ReadOnly)) {
+    error = QObject::tr("Failed to open language model %1").arg(fileName);
+    return false;
+  }
+
+  const auto size = file_.size();
+  if (size < qint64(sizeof(Header))) {
+    error = QObject::tr("Language model is too small %1").arg(fileName);
+    return false;
+  }
+
+  const auto data = file_.map(0, size);
+  if (!data) {
+    error = QObject::tr("Failed to map language model %1").arg(fileName);
+    return false;
+  }
+
+  header_ = reinterpret_cast<const Header*>(data);
+  if (memcmp(header_->magic, magic, sizeof(magic)) != 0 ||
+      header_->version != supportedVersion || header_->order < 1) {
+    error = QObject::tr("Unsupported language model %1").arg(fileName);
+    return false;
+  }
+
+  const auto count = qint64(header_->count);
+  const auto expected = qint64(sizeof(Header)) +
+                        count * qint64(sizeof(quint64) + sizeof(quint8));
+  if (size < expected) {
+    error = QObject::tr("Language model is truncated %1").arg(fileName);
+    return false;
+  }
+
+  hashes_ = reinterpret_cast<const quint64*>(data + sizeof(Header));
+  codes_ = reinterpret_cast<const quint8*>(hashes_ + count);
+  return true;
+}
+
+int NgramModel::order() const
+{
+  return header_ ? int(header_->order) : 0;
+}
+
+bool NgramModel::find(quint64 hash, double& logProb) const
+{
+  const auto end = hashes_ + header_->count;
+  const auto it = std::lower_bound(hashes_, end, hash);
+  if (it == end || *it != hash)
+    return false;
+  logProb = header_->quantization[codes_[it - hashes_]];
+  return true;
+}
+
+double NgramModel::score(const QStringList& context, const QString& word) const
+{
+  SOFT_ASSERT(header_, return 0.0);
+
+  // stupid backoff: use the longest known n-gram, penalizing each step down
+  const auto maxContext = std::min(context.size(), order() - 1);
+  auto penalty = 0.0;
+  for (auto length = maxContext; length >= 0; --length) {
+    auto ngram = context.mid(context.size() - length);
+    ngram.append(word);
+
+    auto logProb = 0.0;
+    if (find(hashNgram(ngram), logProb))
+      return logProb + penalty;
+
+    penalty += header_->backoffPenalty;
+  }
+
+  return header_->unknownLogProb + penalty;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QFile>
+#include <QStringList>
+
+#include <memory>
+
+class NgramModel;
+using NgramModelPtr = std::shared_ptr<const NgramModel>;
+
+// Memory mapped n-gram language model with quantized log10 probabilities.
+// Instances are immutable and shared between threads.
+class NgramModel
+{
+public:
+  ~NgramModel();
+
+  static NgramModelPtr load(const QString& fileName, QString& error);
+
+  int order() const;
+  double score(const QStringList& context, const QString& word) const;
+
+private:
+  struct Header;
+  NgramModel() = default;
+  bool init(const QString& fileName, QString& error);
+  bool find(quint64 hash, double& logProb) const;
+
+  QFile file_;
+  const Header* header_{nullptr};
+  const quint64* hashes_{nullptr};
+  const quint8* codes_{nullptr};
+};
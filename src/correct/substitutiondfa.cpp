@@ -0,0 +1,663 @@
+#include "substitutiondfa.h"
+#include "debug.h"
+
+#include <QObject>
+
+#include <algorithm>
+
+namespace
+{
+const auto unknownState = -2;
+const auto deadState = -1;
+const auto maxStates = 4000;
+const auto maxRepetition = 100;
+const auto lastChar = 0xffff;
+
+using Ranges = std::vector<std::pair<ushort, ushort>>;
+
+void normalize(Ranges &ranges)
+{
+  std::sort(ranges.begin(), ranges.end());
+  Ranges result;
+  for (const auto &range : ranges) {
+    if (!result.empty() && range.first <= result.back().second + 1) {
+      result.back().second = std::max(result.back().second, range.second);
+      continue;
+    }
+    result.push_back(range);
+  }
+  ranges.swap(result);
+}
+
+Ranges complement(const Ranges &ranges)
+{
+  Ranges result;
+  auto next = 0;
+  for (const auto &range : ranges) {
+    if (range.first > next)
+      result.emplace_back(ushort(next), ushort(range.first - 1));
+    next = range.second + 1;
+  }
+  if (next <= lastChar)
+    result.emplace_back(ushort(next), ushort(lastChar));
+  return result;
+}
+
+template <typename Predicate>
+Ranges rangesOf(Predicate predicate)
+{
+  Ranges result;
+  for (auto c = 0; c <= lastChar; ++c) {
+    if (!predicate(QChar(c)))
+      continue;
+    if (!result.empty() && result.back().second + 1 == c)
+      result.back().second = ushort(c);
+    else
+      result.emplace_back(ushort(c), ushort(c));
+  }
+  return result;
+}
+
+bool isWordChar(QChar c)
+{
+  return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+const Ranges &wordRanges()
+{
+  static const auto ranges = rangesOf(isWordChar);
+  return ranges;
+}
+
+const Ranges &digitRanges()
+{
+  static const auto ranges = rangesOf([](QChar c) { return c.isDigit(); });
+  return ranges;
+}
+
+const Ranges &spaceRanges()
+{
+  static const auto ranges = rangesOf([](QChar c) { return c.isSpace(); });
+  return ranges;
+}
+
+bool contains(const Ranges &ranges, ushort c)
+{
+  auto it = std::upper_bound(
+      ranges.cbegin(), ranges.cend(), c,
+      [](ushort c, const std::pair<ushort, ushort> &r) { return c < r.first; });
+  if (it == ranges.cbegin())
+    return false;
+  --it;
+  return c <= it->second;
+}
+
+}  // namespace
+
+// Recursive descent parser for the supported regex subset: alternation,
+// groups, classes, . \d \w \s, greedy quantifiers and anchors at the edges.
+class SubstitutionDfa::Parser
+{
+public:
+  Parser(SubstitutionDfa &dfa, const QString &pattern)
+    : dfa_(dfa)
+    , pattern_(pattern)
+  {
+  }
+
+  int parse(int &assertions, QString &error)
+  {
+    const auto root = alternation(0);
+    if (error_.isEmpty() && pos_ < pattern_.size())
+      error_ = QObject::tr("unmatched )");
+    if (error_.isEmpty() && assertions_ != 0 &&
+        nodes_[root].kind == Node::Kind::Alternate)
+      error_ = QObject::tr("anchors with top level alternation");
+    assertions = assertions_;
+    error = error_;
+    return root;
+  }
+
+  int build(int node, int next)
+  {
+    const auto &n = nodes_[node];
+    switch (n.kind) {
+      case Node::Kind::Empty: return next;
+
+      case Node::Kind::Set:
+        return dfa_.addNode(NfaNode::Kind::Char, n.set, next);
+
+      case Node::Kind::Concat:
+        for (auto it = n.children.crbegin(); it != n.children.crend(); ++it)
+          next = build(*it, next);
+        return next;
+
+      case Node::Kind::Alternate: {
+        auto result = build(n.children.back(), next);
+        for (auto i = int(n.children.size()) - 2; i >= 0; --i) {
+          const auto branch = build(n.children[i], next);
+          result = dfa_.addNode(NfaNode::Kind::Split, -1, branch, result);
+        }
+        return result;
+      }
+
+      case Node::Kind::Repeat: {
+        auto result = next;
+        if (n.max < 0) {
+          const auto loop = dfa_.addNode(NfaNode::Kind::Split, -1, -1, next);
+          const auto body = build(n.children.front(), loop);
+          dfa_.nfa_[loop].out = body;
+          result = loop;
+        } else {
+          for (auto i = n.min; i < n.max; ++i) {
+            const auto body = build(n.children.front(), result);
+            result = dfa_.addNode(NfaNode::Kind::Split, -1, body, next);
+          }
+        }
+        for (auto i = 0; i < n.min; ++i)
+          result = build(n.children.front(), result);
+        return result;
+      }
+    }
+    return next;
+  }
+
+private:
+  struct Node {
+    enum class Kind { Empty, Set, Concat, Alternate, Repeat };
+    Kind kind;
+    int set;
+    std::vector<int> children;
+    int min;
+    int max;
+  };
+
+  int add(Node::Kind kind, std::vector<int> children = {}, int set = -1,
+          int min = 0, int max = 0)
+  {
+    nodes_.push_back(Node{kind, set, std::move(children), min, max});
+    return int(nodes_.size()) - 1;
+  }
+
+  bool atEnd() const { return pos_ >= pattern_.size(); }
+  QChar peek() const { return atEnd() ? QChar() : pattern_[pos_]; }
+
+  int alternation(int depth)
+  {
+    std::vector<int> branches{concatenation(depth)};
+    while (error_.isEmpty() && peek() == QLatin1Char('|')) {
+      ++pos_;
+      branches.push_back(concatenation(depth));
+    }
+    if (branches.size() == 1)
+      return branches.front();
+    return add(Node::Kind::Alternate, std::move(branches));
+  }
+
+  int concatenation(int depth)
+  {
+    std::vector<int> items;
+    while (error_.isEmpty() && !atEnd()) {
+      const auto c = peek();
+      if (c == QLatin1Char('|'))
+        break;
+      if (c == QLatin1Char(')')) {
+        if (depth == 0)
+          error_ = QObject::tr("unmatched )");
+        break;
+      }
+      items.push_back(repetition(depth));
+    }
+    if (items.size() == 1)
+      return items.front();
+    return add(Node::Kind::Concat, std::move(items));
+  }
+
+  int repetition(int depth)
+  {
+    auto node = atom(depth);
+    while (error_.isEmpty() && !atEnd()) {
+      auto min = 0, max = -1;
+      const auto c = peek();
+      if (c == QLatin1Char('*')) {
+        ++pos_;
+      } else if (c == QLatin1Char('+')) {
+        ++pos_;
+        min = 1;
+      } else if (c == QLatin1Char('?')) {
+        ++pos_;
+        max = 1;
+      } else if (c != QLatin1Char('{') || !bounds(min, max)) {
+        break;
+      }
+
+      if (peek() == QLatin1Char('?'))  // lazy makes no sense for dfa
+        ++pos_;
+      if (nodes_[node].kind == Node::Kind::Empty)
+        error_ = QObject::tr("nothing to repeat");
+      node = add(Node::Kind::Repeat, {node}, -1, min, max);
+    }
+    return node;
+  }
+
+  bool bounds(int &min, int &max)
+  {
+    static const QRegularExpression expression(
+        QStringLiteral("\\{(\\d+)(,(\\d*))?\\}"));
+    const auto match = expression.match(
+        pattern_, pos_, QRegularExpression::NormalMatch,
+        QRegularExpression::AnchoredMatchOption);
+    if (!match.hasMatch())
+      return false;
+
+    min = match.captured(1).toInt();
+    max = min;
+    if (match.capturedLength(2) > 0)
+      max = match.capturedLength(3) > 0 ? match.captured(3).toInt() : -1;
+    if (min > maxRepetition || max > maxRepetition ||
+        (max >= 0 && max < min)) {
+      error_ = QObject::tr("bad repetition %1").arg(match.captured());
+    }
+    pos_ = match.capturedEnd();
+    return true;
+  }
+
+  int atom(int depth)
+  {
+    const auto start = pos_;
+    const auto c = pattern_[pos_++];
+
+    if (c == QLatin1Char('(')) {
+      if (pattern_.midRef(pos_, 2) == QLatin1String("?:"))
+        pos_ += 2;
+      else if (peek() == QLatin1Char('?'))
+        error_ = QObject::tr("unsupported group");
+      const auto node = alternation(depth + 1);
+      if (peek() != QLatin1Char(')')) {
+        error_ = QObject::tr("missing )");
+        return node;
+      }
+      ++pos_;
+      return node;
+    }
+
+    if (c == QLatin1Char('^') || c == QLatin1Char('$')) {
+      const auto isStart = c == QLatin1Char('^');
+      if ((isStart && start != 0) || (!isStart && !atEnd()) || depth != 0)
+        error_ = QObject::tr("anchors are supported only at pattern edges");
+      assertions_ |= isStart ? LineStart : LineEnd;
+      return add(Node::Kind::Empty);
+    }
+
+    if (c == QLatin1Char('.'))
+      return set(complement({{ushort('\n'), ushort('\n')}}));
+
+    if (c == QLatin1Char('['))
+      return set(charClass());
+
+    if (c == QLatin1Char('\\')) {
+      if (peek() == QLatin1Char('b')) {
+        ++pos_;
+        const auto isStart = start == 0;
+        if ((!isStart && !atEnd()) || depth != 0)
+          error_ = QObject::tr("\\b is supported only at pattern edges");
+        assertions_ |= isStart ? BoundaryStart : BoundaryEnd;
+        return add(Node::Kind::Empty);
+      }
+      return set(escape());
+    }
+
+    if (c == QLatin1Char('*') || c == QLatin1Char('+') ||
+        c == QLatin1Char('?')) {
+      error_ = QObject::tr("nothing to repeat");
+      return add(Node::Kind::Empty);
+    }
+
+    return set({{c.unicode(), c.unicode()}});
+  }
+
+  Ranges escape()
+  {
+    if (atEnd()) {
+      error_ = QObject::tr("trailing \\");
+      return {};
+    }
+
+    const auto c = pattern_[pos_++];
+    switch (c.unicode()) {
+      case 'd': return digitRanges();
+      case 'D': return complement(digitRanges());
+      case 'w': return wordRanges();
+      case 'W': return complement(wordRanges());
+      case 's': return spaceRanges();
+      case 'S': return complement(spaceRanges());
+      case 'n': return {{ushort('\n'), ushort('\n')}};
+      case 'r': return {{ushort('\r'), ushort('\r')}};
+      case 't': return {{ushort('\t'), ushort('\t')}};
+    }
+
+    if (c.isLetterOrNumber() && c.unicode() < 0x80)
+      error_ = QObject::tr("unsupported escape \\%1").arg(c);
+    return {{c.unicode(), c.unicode()}};
+  }
+
+  Ranges charClass()
+  {
+    Ranges result;
+    const auto isNegated = peek() == QLatin1Char('^');
+    if (isNegated)
+      ++pos_;
+
+    auto isFirst = true;
+    while (error_.isEmpty()) {
+      if (atEnd()) {
+        error_ = QObject::tr("missing ]");
+        break;
+      }
+
+      auto c = pattern_[pos_++];
+      if (c == QLatin1Char(']') && !isFirst)
+        break;
+      isFirst = false;
+
+      if (c == QLatin1Char('\\')) {
+        const auto escaped = escape();
+        if (escaped.size() != 1 ||
+            escaped.front().first != escaped.front().second) {
+          result.insert(result.end(), escaped.cbegin(), escaped.cend());
+          continue;
+        }
+        c = QChar(escaped.front().first);
+      }
+
+      auto last = c;
+      if (peek() == QLatin1Char('-') && pos_ + 1 < pattern_.size() &&
+          pattern_[pos_ + 1] != QLatin1Char(']')) {
+        last = pattern_[pos_ + 1];
+        pos_ += 2;
+        if (last == QLatin1Char('\\')) {
+          const auto escaped = escape();
+          if (escaped.size() == 1)
+            last = QChar(escaped.front().second);
+        }
+        if (last < c)
+          error_ = QObject::tr("bad range");
+      }
+      result.emplace_back(c.unicode(), last.unicode());
+    }
+
+    normalize(result);
+    return isNegated ? complement(result) : result;
+  }
+
+  int set(Ranges ranges)
+  {
+    return add(Node::Kind::Set, {}, dfa_.addSet(std::move(ranges)));
+  }
+
+  SubstitutionDfa &dfa_;
+  const QString &pattern_;
+  int pos_{0};
+  int assertions_{0};
+  QString error_;
+  std::vector<Node> nodes_;
+};
+
+SubstitutionDfa::SubstitutionDfa(const std::vector<Substitution> &rules)
+{
+  static const QRegularExpression backReference(QStringLiteral("\\\\\\d"));
+
+  for (const auto &rule : rules) {
+    const auto isRegex = rule.type == SubstitutionType::Regex;
+    const auto pattern =
+        isRegex ? rule.source : QRegularExpression::escape(rule.source);
+    if (pattern.isEmpty())
+      continue;
+
+    Parser parser(*this, pattern);
+    auto assertions = 0;
+    QString error;
+    const auto root = parser.parse(assertions, error);
+    if (!error.isEmpty()) {
+      errors_.append(QObject::tr("Substitution \"%1\" is not supported: %2")
+                         .arg(rule.source, error));
+      continue;
+    }
+
+    if (rule.type == SubstitutionType::Word)
+      assertions |= WholeWord;
+
+    Rule compiled{rule.target, assertions, {}};
+    if (isRegex && rule.target.contains(backReference)) {
+      compiled.expansion.setPattern(QLatin1String("\\A(?:") + rule.source +
+                                    QLatin1String(")\\z"));
+    }
+
+    const auto index = int(rules_.size());
+    rules_.push_back(std::move(compiled));
+    const auto match = addNode(NfaNode::Kind::Match, index, -1);
+    starts_.push_back(parser.build(root, match));
+  }
+
+  buildClasses();
+  LTRACE() << "Compiled substitutions" << LARG(rules_.size())
+           << LARG(nfa_.size()) << LARG(classRepresentatives_.size());
+}
+
+const QStringList &SubstitutionDfa::errors() const
+{
+  return errors_;
+}
+
+bool SubstitutionDfa::isEmpty() const
+{
+  return rules_.empty();
+}
+
+QString SubstitutionDfa::apply(const QString &text)
+{
+  if (isEmpty())
+    return text;
+
+  QString result;
+  auto copied = 0;
+  for (auto pos = 0, size = text.size(); pos < size;) {
+    auto state = startState();
+    auto matchEnd = -1;
+    auto matchRule = -1;
+
+    for (auto i = pos; i < size; ++i) {
+      state = transition(state, classes_[text[i].unicode()]);
+      if (state == deadState)
+        break;
+
+      for (const auto rule : stateRules_[state]) {
+        if (!isAllowed(rules_[rule], text, pos, i + 1))
+          continue;
+        matchEnd = i + 1;
+        matchRule = rule;
+        break;
+      }
+    }
+
+    if (matchRule < 0) {
+      ++pos;
+      continue;
+    }
+
+    result += text.midRef(copied, pos - copied);
+    result += expand(rules_[matchRule], text.mid(pos, matchEnd - pos));
+    pos = copied = matchEnd;
+  }
+
+  if (copied == 0)
+    return text;
+
+  result += text.midRef(copied);
+  return result;
+}
+
+int SubstitutionDfa::addSet(Ranges ranges)
+{
+  normalize(ranges);
+  sets_.push_back(std::move(ranges));
+  return int(sets_.size()) - 1;
+}
+
+int SubstitutionDfa::addNode(NfaNode::Kind kind, int set, int out,
+                             int alternative)
+{
+  nfa_.push_back(NfaNode{kind, set, out, alternative});
+  return int(nfa_.size()) - 1;
+}
+
+void SubstitutionDfa::buildClasses()
+{
+  // characters, that are not distinguished by any set, share a class
+  std::vector<int> boundaries{0, lastChar + 1};
+  for (const auto &set : sets_) {
+    for (const auto &range : set) {
+      boundaries.push_back(range.first);
+      boundaries.push_back(range.second + 1);
+    }
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+                   boundaries.end());
+
+  classes_.resize(lastChar + 1);
+  classRepresentatives_.clear();
+  for (size_t i = 0, end = boundaries.size() - 1; i < end; ++i) {
+    const auto index = ushort(classRepresentatives_.size());
+    std::fill(classes_.begin() + boundaries[i],
+              classes_.begin() + boundaries[i + 1], index);
+    classRepresentatives_.push_back(ushort(boundaries[i]));
+  }
+}
+
+void SubstitutionDfa::addClosure(int node, QVector<int> &nodes,
+                                 std::vector<bool> &visited) const
+{
+  std::vector<int> stack{node};
+  while (!stack.empty()) {
+    const auto current = stack.back();
+    stack.pop_back();
+    if (current < 0 || visited[current])
+      continue;
+    visited[current] = true;
+
+    const auto &n = nfa_[current];
+    if (n.kind == NfaNode::Kind::Split) {
+      stack.push_back(n.alternative);
+      stack.push_back(n.out);
+      continue;
+    }
+    nodes.append(current);
+  }
+}
+
+int SubstitutionDfa::state(QVector<int> nodes)
+{
+  std::sort(nodes.begin(), nodes.end());
+
+  const auto it = stateIndexes_.constFind(nodes);
+  if (it != stateIndexes_.cend())
+    return it.value();
+
+  std::vector<int> rules;
+  for (const auto node : nodes) {
+    if (nfa_[node].kind == NfaNode::Kind::Match)
+      rules.push_back(nfa_[node].set);
+  }
+  std::sort(rules.begin(), rules.end());
+
+  const auto index = int(stateNodes_.size());
+  stateIndexes_.insert(nodes, index);
+  stateNodes_.push_back(std::move(nodes));
+  stateRules_.push_back(std::move(rules));
+  transitions_.resize(transitions_.size() + classRepresentatives_.size(),
+                      unknownState);
+  return index;
+}
+
+int SubstitutionDfa::startState()
+{
+  if (startState_ >= 0)
+    return startState_;
+
+  QVector<int> nodes;
+  std::vector<bool> visited(nfa_.size(), false);
+  for (const auto start : starts_) addClosure(start, nodes, visited);
+  startState_ = state(std::move(nodes));
+  return startState_;
+}
+
+int SubstitutionDfa::transition(int state, int charClass)
+{
+  const auto cell = size_t(state) * classRepresentatives_.size() + charClass;
+  if (transitions_[cell] != unknownState)
+    return transitions_[cell];
+
+  const auto c = classRepresentatives_[charClass];
+  QVector<int> nodes;
+  std::vector<bool> visited(nfa_.size(), false);
+  for (const auto node : stateNodes_[state]) {
+    const auto &n = nfa_[node];
+    if (n.kind == NfaNode::Kind::Char && contains(sets_[n.set], c))
+      addClosure(n.out, nodes, visited);
+  }
+
+  if (nodes.isEmpty()) {
+    transitions_[cell] = deadState;
+    return deadState;
+  }
+
+  if (int(stateNodes_.size()) >= maxStates) {
+    LTRACE() << "Substitution dfa cache is full, flushing";
+    stateIndexes_.clear();
+    stateNodes_.clear();
+    stateRules_.clear();
+    transitions_.clear();
+    startState_ = -1;
+    return this->state(std::move(nodes));
+  }
+
+  const auto next = this->state(std::move(nodes));
+  transitions_[cell] = next;
+  return next;
+}
+
+bool SubstitutionDfa::isAllowed(const Rule &rule, const QString &text,
+                                int start, int end) const
+{
+  const auto assertions = rule.assertions;
+  if (assertions == 0)
+    return true;
+
+  const auto isWord = [&text](int i) {
+    return i >= 0 && i < text.size() && isWordChar(text[i]);
+  };
+  const auto newLine = QLatin1Char('\n');
+
+  if ((assertions & LineStart) && start > 0 && text[start - 1] != newLine)
+    return false;
+  if ((assertions & LineEnd) && end < text.size() && text[end] != newLine)
+    return false;
+  if ((assertions & BoundaryStart) && isWord(start - 1) == isWord(start))
+    return false;
+  if ((assertions & BoundaryEnd) && isWord(end - 1) == isWord(end))
+    return false;
+  if ((assertions & WholeWord) && (isWord(start - 1) || isWord(end)))
+    return false;
+  return true;
+}
+
+QString SubstitutionDfa::expand(const Rule &rule, const QString &matched) const
+{
+  if (rule.expansion.pattern().isEmpty())
+    return rule.target;
+
+  auto result = matched;
+  result.replace(rule.expansion, rule.target);
+  return result;
+}
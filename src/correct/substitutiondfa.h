@@ -0,0 +1,78 @@
+#pragma once
+
+#include "settings.h"
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QVector>
+
+#include <vector>
+
+// All substitution rules (text, whole word or regex) compiled into one lazily
+// built DFA. Text is rewritten left to right with leftmost-longest matches,
+// preferring the rule with the lowest index among equal ones. DFA is run
+// again from every position without a match, so the text is scanned once per
+// character of the longest possible match: linear for text and bounded
+// rules, quadratic in the worst case with unbounded quantifiers, which need
+// look ahead up to the end of text for the longest match.
+// Not thread safe, even apply adds states and transitions to the DFA.
+class SubstitutionDfa
+{
+public:
+  explicit SubstitutionDfa(const std::vector<Substitution>& rules);
+
+  const QStringList& errors() const;
+  bool isEmpty() const;
+  // Non-const, builds missing parts of the DFA.
+  QString apply(const QString& text);
+
+private:
+  enum Assertion {
+    LineStart = 0x1,
+    LineEnd = 0x2,
+    BoundaryStart = 0x4,
+    BoundaryEnd = 0x8,
+    WholeWord = 0x10,
+  };
+  struct Rule {
+    QString target;
+    int assertions;
+    QRegularExpression expansion;
+  };
+  struct NfaNode {
+    enum class Kind { Char, Split, Match };
+    Kind kind;
+    int set;  // char set for Char, rule for Match
+    int out;
+    int alternative;
+  };
+  using Ranges = std::vector<std::pair<ushort, ushort>>;
+  class Parser;
+
+  int addSet(Ranges ranges);
+  int addNode(NfaNode::Kind kind, int set, int out, int alternative = -1);
+  void buildClasses();
+  void addClosure(int node, QVector<int>& nodes,
+                  std::vector<bool>& visited) const;
+  int state(QVector<int> nodes);
+  int transition(int state, int charClass);
+  int startState();
+  bool isAllowed(const Rule& rule, const QString& text, int start,
+                 int end) const;
+  QString expand(const Rule& rule, const QString& matched) const;
+
+  QStringList errors_;
+  std::vector<Rule> rules_;
+  std::vector<Ranges> sets_;
+  std::vector<NfaNode> nfa_;
+  std::vector<int> starts_;
+
+  std::vector<ushort> classes_;
+  std::vector<ushort> classRepresentatives_;
+
+  QHash<QVector<int>, int> stateIndexes_;
+  std::vector<QVector<int>> stateNodes_;
+  std::vector<std::vector<int>> stateRules_;
+  std::vector<int> transitions_;
+  int startState_{-1};
+};
@@ -0,0 +1,75 @@
+#include "usersubstitutions.h"
+#include "debug.h"
+#include "languagecodes.h"
+#include "substitutiondfa.h"
+
+#include <algorithm>
+
+UserSubstitutions::UserSubstitutions(const Substitutions &all)
+{
+  const auto anyId = LanguageCodes::anyLanguageId();
+  const auto byLength = [](const Substitution &l, const Substitution &r) {
+    return l.source.size() > r.source.size();
+  };
+
+  std::vector<Substitution> anyRules;
+  {
+    const auto range = all.equal_range(anyId);
+    for (auto it = range.first; it != range.second; ++it)
+      anyRules.push_back(it->second);
+    std::stable_sort(anyRules.begin(), anyRules.end(), byLength);
+  }
+
+  LanguageIds languages{anyId};
+  for (const auto &i : all) {
+    if (!languages.contains(i.first))
+      languages.append(i.first);
+  }
+
+  for (const auto &language : languages) {
+    std::vector<Substitution> rules;
+    if (language != anyId) {
+      const auto range = all.equal_range(language);
+      for (auto it = range.first; it != range.second; ++it)
+        rules.push_back(it->second);
+      std::stable_sort(rules.begin(), rules.end(), byLength);
+    }
+    rules.insert(rules.end(), anyRules.cbegin(), anyRules.cend());
+    if (rules.empty())
+      continue;
+
+    auto dfa = std::make_unique<SubstitutionDfa>(rules);
+    for (const auto &error : dfa->errors()) {
+      if (!errors_.contains(error))  // rules of any language are in every dfa
+        errors_.append(error);
+    }
+    dfas_.emplace(language, std::move(dfa));
+  }
+
+  LTRACE() << "Compiled user substitutions" << LARG(dfas_.size());
+}
+
+UserSubstitutions::~UserSubstitutions() = default;
+
+const QStringList &UserSubstitutions::errors() const
+{
+  return errors_;
+}
+
+bool UserSubstitutions::isEmpty() const
+{
+  return dfas_.empty();
+}
+
+QString UserSubstitutions::apply(const QString &text,
+                                 const LanguageId &language)
+{
+  auto it = dfas_.find(language);
+  if (it == dfas_.cend())
+    it = dfas_.find(LanguageCodes::anyLanguageId());
+  if (it == dfas_.cend())
+    return text;
+
+  SOFT_ASSERT(it->second, return text);
+  return it->second->apply(text);
+}
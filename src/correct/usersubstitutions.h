@@ -0,0 +1,32 @@
+#pragma once
+
+#include "settings.h"
+
+#include <QMetaType>
+
+#include <memory>
+#include <unordered_map>
+
+class SubstitutionDfa;
+
+// User substitutions of every language, compiled to one DFA per language.
+// Rules of any language are applied after language specific ones. Not
+// thread safe, like its DFAs, so every thread uses its own instance.
+class UserSubstitutions
+{
+public:
+  explicit UserSubstitutions(const Substitutions& all);
+  ~UserSubstitutions();
+
+  const QStringList& errors() const;
+  bool isEmpty() const;
+  QString apply(const QString& text, const LanguageId& language);
+
+private:
+  std::unordered_map<LanguageId, std::unique_ptr<SubstitutionDfa>> dfas_;
+  QStringList errors_;
+};
+
+using UserSubstitutionsPtr = std::shared_ptr<UserSubstitutions>;
+
+Q_DECLARE_METATYPE(UserSubstitutionsPtr);
@@ -1,15 +1,30 @@
 #include "apptranslator.h"
 #include "manager.h"
+#include "ocrprocess.h"
 #include "singleapplication.h"
+#include "tesseract.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
 
+#ifdef WITH_MIMALLOC
+// replaces global new and delete
+#include <mimalloc-new-delete.h>
+#endif
+
 #define STR2(XXX) #XXX
 #define STR(XXX) STR2(XXX)
 
 int main(int argc, char *argv[])
 {
+  Tesseract::usePixPool();
+
+  if (argc == 3 && OcrProcess::helperArgument() == QLatin1String(argv[1])) {
+    QGuiApplication helper(argc, argv);
+    setlocale(LC_NUMERIC, "C");
+    return OcrProcess::runHelper(QString::fromLocal8Bit(argv[2]));
+  }
+
   QApplication a(argc, argv);
   a.setApplicationName("ScreenTranslator");
   a.setOrganizationName("Gres");
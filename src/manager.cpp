@@ -2,6 +2,12 @@
 #include "capturer.h"
 #include "corrector.h"
 #include "debug.h"
+#include "globalaction.h"
+#include "latencymonitor.h"
+#include "memoryregistry.h"
+#include "pdfdocument.h"
+#include "pipeline.h"
+#include "pixpool.h"
 #include "recognizer.h"
 #include "representer.h"
 #include "settingseditor.h"
@@ -11,11 +17,15 @@
 #include "updates.h"
 
 #include <QApplication>
+#include <QClipboard>
 #include <QDesktopServices>
+#include <QFileDialog>
 #include <QFileInfo>
+#include <QImageReader>
 #include <QMessageBox>
 #include <QNetworkProxy>
 #include <QThread>
+#include <QTimer>
 
 namespace
 {
@@ -27,39 +37,55 @@ const auto updatesUrl =
     "updates.json";
 #endif
 const auto resultHideWaitUs = 300'000;
+const auto memoryCheckIntervalMs = 60'000;
+const auto mb = qint64(1024 * 1024);
 }  // namespace
 using Loader = update::Loader;
 
 Manager::Manager()
   : settings_(std::make_unique<Settings>())
+  , pipeline_(std::make_unique<Pipeline>())
   , updater_(std::make_unique<Loader>(Loader::Urls{{updatesUrl}}))
   , updateAutoChecker_(std::make_unique<update::AutoChecker>(*updater_))
   , models_(std::make_unique<CommonModels>())
+  , watchTimer_(std::make_unique<QTimer>())
+  , latency_(std::make_unique<service::LatencyMonitor>())
+  , memory_(std::make_unique<service::MemoryRegistry>())
+  , memoryTimer_(std::make_unique<QTimer>())
 {
   SOFT_ASSERT(settings_, return );
+  startupTimer_.start();
 
   // updater components
   (void)QT_TRANSLATE_NOOP("QObject", "app");
   (void)QT_TRANSLATE_NOOP("QObject", "recognizers");
+  (void)QT_TRANSLATE_NOOP("QObject", "recognizers_fast");
   (void)QT_TRANSLATE_NOOP("QObject", "hunspell");
   (void)QT_TRANSLATE_NOOP("QObject", "translators");
 
   tray_ = std::make_unique<TrayIcon>(*this, *settings_);
   capturer_ = std::make_unique<Capturer>(*this, *settings_, *models_);
   recognizer_ = std::make_unique<Recognizer>(*this, *settings_);
-  translator_ = std::make_unique<Translator>(*this, *settings_);
   corrector_ = std::make_unique<Corrector>(*this, *settings_);
   representer_ =
       std::make_unique<Representer>(*this, *tray_, *settings_, *models_);
   qRegisterMetaType<TaskPtr>();
 
+  QObject::connect(watchTimer_.get(), &QTimer::timeout,  //
+                   watchTimer_.get(), [this] { watchLocked(); });
+
+  setupMemoryRegistry();
+  setupPipeline();
+
   settings_->load();
   updateSettings();
+  markStartup(QObject::tr("Tray and hotkeys"));
 
   if (settings_->showMessageOnStart)
     tray_->showInformation(QObject::tr("Screen translator started"));
 
-  warnIfOutdated();
+  // heavy parts are loaded after the event loop makes tray usable
+  QTimer::singleShot(0, tray_.get(), [this] { startProcessing(); });
 
   QObject::connect(updater_.get(), &update::Loader::error,  //
                    tray_.get(), &TrayIcon::showError);
@@ -83,6 +109,107 @@ Manager::~Manager()
   }
 }
 
+void Manager::startProcessing()
+{
+  if (startupPhase_ != StartupPhase::Tray)
+    return;
+
+  startupPhase_ = StartupPhase::Processing;
+  updateProcessingSettings();
+  recognizer_->prewarm();
+  markStartup(QObject::tr("Recognition and correction"));
+
+  QTimer::singleShot(0, tray_.get(), [this] { finishStartup(); });
+}
+
+void Manager::finishStartup()
+{
+  if (startupPhase_ != StartupPhase::Processing)
+    return;
+
+  translator();
+  markStartup(QObject::tr("Translators"));
+
+  startupPhase_ = StartupPhase::Finished;
+  setupUpdates(*settings_);
+  warnIfOutdated();
+  markStartup(QObject::tr("Update checks"));
+}
+
+void Manager::markStartup(const QString &name)
+{
+  const auto elapsed = startupTimer_.elapsed();
+  LTRACE() << "Startup phase" << name << LARG(elapsed);
+  startupTimes_.append(QObject::tr("%1: %2 ms").arg(name).arg(elapsed));
+}
+
+Translator &Manager::translator()
+{
+  // web engine initialization is the slowest part of startup
+  if (!translator_) {
+    translator_ = std::make_unique<Translator>(*this, *settings_);
+    translator_->updateSettings();
+  }
+  return *translator_;
+}
+
+void Manager::setupMemoryRegistry()
+{
+  memory_->add(
+      QObject::tr("Screenshot"), [this] { return capturer_->memoryUsage(); },
+      200 * mb, [this] { capturer_->releaseMemory(); });
+  memory_->add(
+      QObject::tr("OCR engines and queue"),
+      [this] { return recognizer_->memoryUsage(); }, 1024 * mb,
+      [this] { recognizer_->releaseMemory(); });
+  memory_->add(
+      QObject::tr("Free image buffers"),
+      [] { return PixPool::instance().stats().pooledBytes; }, 64 * mb,
+      [] { PixPool::instance().clear(); });
+  memory_->add(
+      QObject::tr("Results"), [this] { return representer_->memoryUsage(); },
+      64 * mb, [this] { representer_->releaseMemory(); });
+  memory_->add(
+      QObject::tr("Translator logs"),
+      [this] { return translator_ ? translator_->memoryUsage() : 0; },
+      8 * mb,
+      [this] {
+        if (translator_)
+          translator_->releaseMemory();
+      });
+
+  memoryTimer_->setInterval(memoryCheckIntervalMs);
+  QObject::connect(memoryTimer_.get(), &QTimer::timeout,  //
+                   memoryTimer_.get(), [this] { memory_->update(); });
+  memoryTimer_->start();
+}
+
+void Manager::setupPipeline()
+{
+  const auto isScreen = [](const TaskPtr &task) {
+    return task->documentPage < 0;
+  };
+  // selected text is translated as is, without ocr fixes
+  const auto isImage = [](const TaskPtr &task) { return !task->isText; };
+
+  pipeline_
+      ->then({QStringLiteral("recognize"),
+              [this](const TaskPtr &task) { recognizer_->recognize(task); },
+              isImage})
+      .then({QStringLiteral("correct"),
+             [this](const TaskPtr &task) { corrector_->correct(task); },
+             isImage})
+      .then({QStringLiteral("translate"),
+             [this](const TaskPtr &task) { translator().translate(task); },
+             [isScreen](const TaskPtr &task) {
+               return isScreen(task) && !task->targetLanguage.isEmpty();
+             },
+             true})  // text is shown even if translation failed
+      .then({QStringLiteral("represent"),
+             [this](const TaskPtr &task) { represent(task); }, isScreen})
+      .finally([this](const TaskPtr &task) { finishTask(task); });
+}
+
 void Manager::warnIfOutdated()
 {
   const auto now = QDateTime::currentDateTime();
@@ -109,18 +236,32 @@ void Manager::updateSettings()
 
   settings_->writeTrace = setupTrace(settings_->writeTrace);
   setupProxy(*settings_);
-  setupUpdates(*settings_);
-
-  models_->update(settings_->tessdataPath);
 
   tray_->updateSettings();
   capturer_->updateSettings();
+
+  tray_->setCaptureLockedEnabled(capturer_->canCaptureLocked());
+  tray_->updateLatency(*latency_);
+  watchTimer_->setInterval(settings_->watchInterval);
+
+  updateProcessingSettings();
+}
+
+void Manager::updateProcessingSettings()
+{
+  if (startupPhase_ == StartupPhase::Tray)  // set up in background
+    return;
+
+  models_->update(settings_->tessdataPath);
+
   recognizer_->updateSettings();
   corrector_->updateSettings();
-  translator_->updateSettings();
+  if (translator_)
+    translator_->updateSettings();
   representer_->updateSettings();
 
-  tray_->setCaptureLockedEnabled(capturer_->canCaptureLocked());
+  if (startupPhase_ == StartupPhase::Finished)
+    setupUpdates(*settings_);
 }
 
 void Manager::setupProxy(const Settings &settings)
@@ -154,6 +295,7 @@ void Manager::setupUpdates(const Settings &settings)
       {"$translators$", settings.translatorsDir},
       {"$tessdata$", settings.tessdataPath},
       {"$hunspell$", settings.hunspellDir},
+      {"$ngrams$", settings.languageModelsDir},
       {"$appdir$", QApplication::applicationDirPath()},
   });
 
@@ -204,9 +346,20 @@ void Manager::finishTask(const TaskPtr &task)
   --activeTaskCount_;
   tray_->setActiveTaskCount(activeTaskCount_);
 
+  if (task->documentPage >= 0) {  // reported once for whole document
+    capturer_->finishPage(task);
+    return;
+  }
+
+  if (task->isWatched && !task->isValid()) {
+    LTRACE() << "Watched area has no text" << task->error;
+    return;
+  }
+
   if (!task->isValid()) {
     tray_->showError(task->error);
-    tray_->setTaskActionsEnabled(false);
+    if (task->latency[size_t(service::LatencyMark::Shown)] == 0)
+      tray_->setTaskActionsEnabled(false);
     return;
   }
 
@@ -220,20 +373,39 @@ void Manager::captured(const TaskPtr &task)
 
   SOFT_ASSERT(task, return );
   LTRACE() << "captured" << task;
+  markCaptured(task);
 
   ++activeTaskCount_;
   tray_->setActiveTaskCount(activeTaskCount_);
 
-  if (!task->isValid()) {
-    finishTask(task);
-    return;
-  }
+  if (task->isValid())
+    startProcessing();  // captured before background startup
 
-  recognizer_->recognize(task);
+  pipeline_->start(task);
+}
+
+void Manager::correctedByUser(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
+  LTRACE() << "correctedByUser" << task;
+
+  using Mark = service::LatencyMark;
+  task->latency = {};
+  task->mark(Mark::Requested);
+  task->mark(Mark::Corrected);
+
+  ++activeTaskCount_;
+  tray_->setActiveTaskCount(activeTaskCount_);
+
+  if (task->isValid())
+    startProcessing();
+
+  pipeline_->startAt(task, QStringLiteral("translate"));
 }
 
 void Manager::captureCanceled()
 {
+  selectorDelay_ = -1;
   tray_->setCaptureLockedEnabled(capturer_->canCaptureLocked());
   tray_->blockActions(false);
 }
@@ -242,40 +414,74 @@ void Manager::recognized(const TaskPtr &task)
 {
   SOFT_ASSERT(task, return );
   LTRACE() << "recognized" << task;
-
-  if (!task->isValid()) {
-    finishTask(task);
-    return;
-  }
-
-  corrector_->correct(task);
+  task->mark(service::LatencyMark::Recognized);
+  pipeline_->advance(task);
 }
 
 void Manager::corrected(const TaskPtr &task)
 {
   SOFT_ASSERT(task, return );
   LTRACE() << "corrected" << task;
-
-  if (!task->isValid()) {
-    finishTask(task);
-    return;
-  }
-
-  if (!task->targetLanguage.isEmpty())
-    translator_->translate(task);
-  else
-    translated(task);
+  task->mark(service::LatencyMark::Corrected);
+  pipeline_->advance(task);
 }
 
 void Manager::translated(const TaskPtr &task)
 {
   SOFT_ASSERT(task, return );
   LTRACE() << "translated" << task;
+  task->mark(service::LatencyMark::Translated);
+  pipeline_->advance(task);
+}
 
-  finishTask(task);
-
+void Manager::represent(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
   representer_->represent(task);
   tray_->setTaskActionsEnabled(!task->isNull());
+
+  task->mark(service::LatencyMark::Shown);
+  updateLatency(task);
+  pipeline_->advance(task);
+}
+
+qint64 Manager::requestTime() const
+{
+  const auto hotkey = service::GlobalAction::triggerTime();
+  return hotkey != 0 ? hotkey : service::LatencyMonitor::now();
+}
+
+void Manager::markCaptured(const TaskPtr &task)
+{
+  using Mark = service::LatencyMark;
+  task->latency = {};  // task might be sent again from result editor
+  task->mark(Mark::Captured);
+  auto &marks = task->latency;
+  const auto captured = marks[size_t(Mark::Captured)];
+  if (requestTime_ != 0)
+    marks[size_t(Mark::Requested)] = requestTime_;
+  else if (selectorDelay_ >= 0)  // time of selection by user is not counted
+    marks[size_t(Mark::Requested)] = captured - selectorDelay_;
+  else
+    marks[size_t(Mark::Requested)] = captured;
+  selectorDelay_ = -1;
+}
+
+void Manager::updateLatency(const TaskPtr &task)
+{
+  if (task->isWatched || task->documentPage >= 0 || !task->isValid())
+    return;
+
+  latency_->add(task->latency);
+  tray_->updateLatency(*latency_);
+}
+
+void Manager::learnCorrection(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
+  SOFT_ASSERT(corrector_, return );
+  LTRACE() << "learnCorrection" << task;
+  corrector_->learn(task->recognized, task->corrected);
 }
 
 void Manager::applySettings(const Settings &settings)
@@ -301,6 +507,7 @@ void Manager::capture()
 {
   SOFT_ASSERT(capturer_, return );
 
+  const auto requested = requestTime();
   tray_->blockActions(true);
 
   if (representer_->isVisible()) {
@@ -309,19 +516,23 @@ void Manager::capture()
   }
 
   capturer_->capture();
+  selectorDelay_ = service::LatencyMonitor::now() - requested;
   tray_->setRepeatCaptureEnabled(true);
 }
 
 void Manager::repeatCapture()
 {
   SOFT_ASSERT(capturer_, return );
+  const auto requested = requestTime();
   tray_->blockActions(true);
   capturer_->repeatCapture();
+  selectorDelay_ = service::LatencyMonitor::now() - requested;
 }
 
 void Manager::captureLocked()
 {
   SOFT_ASSERT(capturer_, return );
+  requestTime_ = requestTime();
 
   if (representer_->isVisible()) {
     representer_->hide();
@@ -329,6 +540,131 @@ void Manager::captureLocked()
   }
 
   capturer_->captureLocked();
+  requestTime_ = 0;
+}
+
+void Manager::translateSelection()
+{
+  SOFT_ASSERT(capturer_, return );
+
+  // x11 primary selection is set without explicit copy
+  const auto clipboard = QApplication::clipboard();
+  auto text = clipboard->supportsSelection()
+                  ? clipboard->text(QClipboard::Selection).trimmed()
+                  : QString();
+  if (text.isEmpty())
+    text = clipboard->text(QClipboard::Clipboard).trimmed();
+
+  if (text.isEmpty()) {
+    const auto image = clipboard->image();
+    if (!image.isNull()) {
+      recognizeImage(image);
+      return;
+    }
+
+    tray_->showError(QObject::tr("No selected text or text in clipboard"));
+    return;
+  }
+
+  requestTime_ = requestTime();
+  capturer_->captureText(text);
+  requestTime_ = 0;
+}
+
+void Manager::recognizeImages(const QStringList &files)
+{
+  SOFT_ASSERT(capturer_, return );
+
+  QStringList images;
+  QStringList failed;
+  for (const auto &file : files) {
+    if (PdfDocument::isDocument(file)) {
+      const auto error = capturer_->captureDocument(file);
+      if (!error.isEmpty())
+        tray_->showError(error);
+      continue;
+    }
+
+    if (QImageReader(file).canRead())
+      images.append(file);
+    else
+      failed.append(file);
+  }
+
+  if (!failed.isEmpty()) {
+    tray_->showError(
+        QObject::tr("Failed to read images:\n%1").arg(failed.join('\n')));
+  }
+
+  if (!images.isEmpty())
+    capturer_->captureImages(images);
+}
+
+void Manager::recognizeImage(const QImage &image)
+{
+  SOFT_ASSERT(capturer_, return );
+  if (image.isNull()) {
+    tray_->showError(QObject::tr("Failed to read image"));
+    return;
+  }
+  capturer_->captureImage(image);
+}
+
+void Manager::openImages()
+{
+  QStringList formats;
+  for (const auto &format : QImageReader::supportedImageFormats())
+    formats.append(QLatin1String("*.") + QString::fromLatin1(format));
+
+  if (PdfDocument::isSupported())
+    formats.append(QLatin1String("*.pdf"));
+
+  const auto files = QFileDialog::getOpenFileNames(
+      nullptr, QObject::tr("Recognize images"), {},
+      QObject::tr("Images (%1)").arg(formats.join(' ')));
+  if (!files.isEmpty())
+    recognizeImages(files);
+}
+
+void Manager::documentRecognized(const QString &outputName,
+                                 const QString &error)
+{
+  LTRACE() << "documentRecognized" << outputName << error;
+  if (!error.isEmpty()) {
+    tray_->showError(error);
+    return;
+  }
+
+  tray_->showInformation(
+      QObject::tr("Document text is saved to %1").arg(outputName));
+}
+
+void Manager::setWatching(bool isOn)
+{
+  SOFT_ASSERT(watchTimer_, return );
+  LTRACE() << "setWatching" << isOn;
+  if (isOn) {
+    watchTimer_->start(settings_->watchInterval);
+    return;
+  }
+
+  watchTimer_->stop();
+  capturer_->resetWatched();
+}
+
+void Manager::watchLocked()
+{
+  SOFT_ASSERT(capturer_, return );
+
+  if (!capturer_->canCaptureLocked()) {
+    tray_->setCaptureLockedEnabled(false);
+    return;
+  }
+
+  if (activeTaskCount_ > 0)  // skip frames while previous is processed
+    return;
+
+  capturer_->watchLocked();
 }
 
 void Manager::settings()
@@ -359,8 +695,23 @@ void Manager::showLast()
 
 void Manager::showTranslator()
 {
-  SOFT_ASSERT(translator_, return );
-  translator_->show();
+  translator().show();
+}
+
+void Manager::showDiagnostics()
+{
+  SOFT_ASSERT(memory_, return );
+  memory_->update();
+  const auto pool = PixPool::instance().stats();
+  const auto buffers =
+      QObject::tr("%1 allocated, %2 reused, peak %3")
+          .arg(pool.allocations)
+          .arg(pool.reused)
+          .arg(service::MemoryRegistry::sizeString(pool.peakBytes));
+  const auto text =
+      QObject::tr("Memory usage:\n%1\nImage buffers: %2\n\nStartup time:\n%3")
+          .arg(memory_->report(), buffers, startupTimes_.join('\n'));
+  QMessageBox::information(nullptr, QObject::tr("Diagnostics"), text);
 }
 
 void Manager::copyLastToClipboard()
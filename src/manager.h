@@ -2,7 +2,18 @@
 
 #include "stfwd.h"
 
-class QString;
+#include <QElapsedTimer>
+#include <QStringList>
+
+class Pipeline;
+class QImage;
+class QTimer;
+
+namespace service
+{
+class LatencyMonitor;
+class MemoryRegistry;
+}  // namespace service
 
 class Manager
 {
@@ -11,29 +22,52 @@ public:
   ~Manager();
 
   void captured(const TaskPtr &task);
+  void correctedByUser(const TaskPtr &task);
   void captureCanceled();
   void recognized(const TaskPtr &task);
   void corrected(const TaskPtr &task);
   void translated(const TaskPtr &task);
+  void learnCorrection(const TaskPtr &task);
 
   void applySettings(const Settings &settings);
   void fatalError(const QString &text);
   void capture();
   void repeatCapture();
   void captureLocked();
+  void setWatching(bool isOn);
+  void translateSelection();
+  void recognizeImages(const QStringList &files);
+  void recognizeImage(const QImage &image);
+  void openImages();
+  void documentRecognized(const QString &outputName, const QString &error);
   void showLast();
   void showTranslator();
+  void showDiagnostics();
   void settings();
   void copyLastToClipboard();
   void quit();
 
 private:
+  enum class StartupPhase { Tray, Processing, Finished };
+
+  void startProcessing();
+  void finishStartup();
+  void markStartup(const QString &name);
+  Translator &translator();
   void updateSettings();
+  void updateProcessingSettings();
   void setupProxy(const Settings &settings);
   void setupUpdates(const Settings &settings);
   bool setupTrace(bool isOn);
   void finishTask(const TaskPtr &task);
   void warnIfOutdated();
+  void watchLocked();
+  qint64 requestTime() const;
+  void markCaptured(const TaskPtr &task);
+  void updateLatency(const TaskPtr &task);
+  void setupMemoryRegistry();
+  void setupPipeline();
+  void represent(const TaskPtr &task);
 
   std::unique_ptr<Settings> settings_;
   std::unique_ptr<TrayIcon> tray_;
@@ -42,8 +76,18 @@ private:
   std::unique_ptr<Corrector> corrector_;
   std::unique_ptr<Translator> translator_;
   std::unique_ptr<Representer> representer_;
+  std::unique_ptr<Pipeline> pipeline_;
   std::unique_ptr<update::Loader> updater_;
   std::unique_ptr<update::AutoChecker> updateAutoChecker_;
   std::unique_ptr<CommonModels> models_;
+  std::unique_ptr<QTimer> watchTimer_;
+  std::unique_ptr<service::LatencyMonitor> latency_;
+  std::unique_ptr<service::MemoryRegistry> memory_;
+  std::unique_ptr<QTimer> memoryTimer_;
+  qint64 requestTime_{0};     // of capture without user interaction
+  qint64 selectorDelay_{-1};  // time to show area selector
   int activeTaskCount_{0};
+  StartupPhase startupPhase_{StartupPhase::Tray};
+  QElapsedTimer startupTimer_;
+  QStringList startupTimes_;
 };
@@ -0,0 +1,151 @@
+#include "imagetiles.h"
+#include "debug.h"
+
+#include <QImageReader>
+#include <QTransform>
+
+#include <algorithm>
+
+namespace
+{
+const auto searchRows = 200;  // at band end to find empty row in
+const auto maxBlankContrast = 32;
+
+bool isBlank(const QImage &gray, int y)
+{
+  const auto row = gray.constScanLine(y);
+  const auto [min, max] = std::minmax_element(row, row + gray.width());
+  return *max - *min <= maxBlankContrast;
+}
+}  // namespace
+
+ImageTiles::ImageTiles(const QString &fileName, int rotation)
+  : fileName_(fileName)
+  , rotation_((rotation % 360 + 360) % 360)
+{
+  QImageReader reader(fileName_);
+  size_ = reader.size();
+  sourceSize_ = size_;
+  const auto canClip = reader.supportsOption(QImageIOHandler::ClipRect);
+  if (size_.isValid() && canClip && rotation_ == 0)
+    return;
+
+  image_ = reader.read();
+  if (image_.isNull()) {
+    error_ = QObject::tr("Failed to read image %1: %2")
+                 .arg(fileName_, reader.errorString());
+    return;
+  }
+  size_ = image_.size();
+  sourceSize_ = size_;
+  rotate();
+}
+
+ImageTiles::ImageTiles(const QImage &image, int rotation)
+  : image_(image)
+  , size_(image.size())
+  , sourceSize_(image.size())
+  , rotation_((rotation % 360 + 360) % 360)
+{
+  if (image_.isNull()) {
+    error_ = QObject::tr("Empty image");
+    return;
+  }
+  rotate();
+}
+
+void ImageTiles::rotate()
+{
+  if (rotation_ == 0)
+    return;
+  image_ = image_.transformed(QTransform().rotate(rotation_));
+  size_ = image_.size();
+  LTRACE() << "Rotated image for tiles" << LARG(rotation_) << LARG(size_);
+}
+
+const QString &ImageTiles::error() const
+{
+  return error_;
+}
+
+QSize ImageTiles::size() const
+{
+  return size_;
+}
+
+QSize ImageTiles::sourceSize() const
+{
+  return sourceSize_;
+}
+
+QRect ImageTiles::toSource(const QRect &rect) const
+{
+  if (rotation_ == 0)
+    return rect;
+  const auto transform = QTransform().rotate(-rotation_);
+  const auto origin =
+      transform.mapRect(QRectF(QPointF(), QSizeF(size_))).topLeft();
+  return transform.mapRect(QRectF(rect)).translated(-origin).toAlignedRect();
+}
+
+bool ImageTiles::atEnd() const
+{
+  return !error_.isEmpty() || top_ >= size_.height();
+}
+
+int ImageTiles::top() const
+{
+  return top_;
+}
+
+QImage ImageTiles::next()
+{
+  if (atEnd())
+    return {};
+
+  const auto height = size_.height() - top_;
+  if (height <= tileHeight + searchRows) {
+    auto last = read({0, top_, size_.width(), height});
+    top_ = size_.height();
+    return last;
+  }
+
+  auto band = read({0, top_, size_.width(), tileHeight + searchRows});
+  if (band.isNull()) {
+    top_ = size_.height();
+    return {};
+  }
+
+  const auto gray = band.convertToFormat(QImage::Format_Grayscale8);
+  auto cut = tileHeight;
+  for (auto y = band.height() - 1; y >= tileHeight - searchRows; --y) {
+    if (!isBlank(gray, y))
+      continue;
+    cut = y + 1;
+    break;
+  }
+
+  LTRACE() << "Image tile" << LARG(top_) << LARG(cut);
+  top_ += cut;
+  return band.copy(0, 0, band.width(), cut);
+}
+
+QImage ImageTiles::read(const QRect &rect)
+{
+  if (!image_.isNull())
+    return image_.copy(rect);
+
+  QImageReader reader(fileName_);
+  reader.setClipRect(rect);
+  auto result = reader.read();
+  if (result.isNull()) {
+    error_ = QObject::tr("Failed to read image %1: %2")
+                 .arg(fileName_, reader.errorString());
+  }
+  return result;
+}
+
+bool ImageTiles::isLarge(const QSize &size)
+{
+  return size.height() > tileHeight + searchRows;
+}
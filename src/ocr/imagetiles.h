@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+// Splits large image to horizontal bands, that are recognized one by one to
+// limit memory usage of OCR. Files are decoded band by band when image format
+// supports reading of its part, otherwise decoded once. Rotated image is
+// turned as a whole first, so bands go along its upright text lines.
+class ImageTiles
+{
+public:
+  // Rotation is clockwise, multiple of 90.
+  explicit ImageTiles(const QString& fileName, int rotation = 0);
+  explicit ImageTiles(const QImage& image, int rotation = 0);
+
+  const QString& error() const;
+  // Of the rotated image.
+  QSize size() const;
+  QSize sourceSize() const;
+  // From the rotated image to the source one.
+  QRect toSource(const QRect& rect) const;
+  bool atEnd() const;
+  // Of the next tile.
+  int top() const;
+  // Cut at empty row near the band end, if there is one.
+  QImage next();
+
+  static bool isLarge(const QSize& size);
+
+  static const int tileHeight = 2000;
+
+private:
+  QImage read(const QRect& rect);
+  void rotate();
+
+  QString fileName_;
+  QImage image_;
+  QSize size_;
+  QSize sourceSize_;
+  int rotation_;
+  int top_{0};
+  QString error_;
+};
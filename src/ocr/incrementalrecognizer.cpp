@@ -0,0 +1,120 @@
+#include "incrementalrecognizer.h"
+#include "debug.h"
+
+#include <QImage>
+
+#include <algorithm>
+
+namespace
+{
+const auto minContrast = 48;  // between text and background in row
+const auto maxGap = 2;        // rows without text inside of line (i dots)
+const auto minHeight = 4;     // thinner bands are borders and separators
+const auto padding = 2;       // extra rows around line passed to OCR
+}  // namespace
+
+QString IncrementalRecognizer::recognize(const QImage &image,
+                                         const RecognizeLine &recognizeLine)
+{
+  SOFT_ASSERT(recognizeLine, return {});
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const auto lines = segment(image);
+
+  QHash<uint, int> previousTops;
+  for (const auto &line : lines_) previousTops.insert(line.hash, line.top);
+
+  QHash<uint, QString> texts;
+  QHash<int, int> offsetVotes;
+  QStringList result;
+  reusedLines_ = 0;
+
+  for (const auto &line : lines) {
+    QString text;
+    if (texts_.contains(line.hash)) {
+      text = texts_.value(line.hash);
+      ++reusedLines_;
+      if (previousTops.contains(line.hash))
+        ++offsetVotes[line.top - previousTops.value(line.hash)];
+    } else if (texts.contains(line.hash)) {
+      text = texts.value(line.hash);
+    } else {
+      const auto rect = QRect(0, line.top - padding, image.width(),
+                              line.bottom - line.top + 2 * padding)
+                            .intersected(image.rect());
+      text = recognizeLine(image.copy(rect)).trimmed();
+    }
+
+    texts.insert(line.hash, text);
+    if (!text.isEmpty())
+      result.append(text);
+  }
+
+  scrollOffset_ = 0;
+  auto bestVotes = 0;
+  for (auto it = offsetVotes.cbegin(), end = offsetVotes.cend(); it != end;
+       ++it) {
+    if (it.value() <= bestVotes)
+      continue;
+    bestVotes = it.value();
+    scrollOffset_ = it.key();
+  }
+
+  LTRACE() << "Incremental recognition" << LARG(lines.size())
+           << LARG(reusedLines_) << LARG(scrollOffset_);
+
+  texts_ = std::move(texts);
+  lines_ = lines;
+  return result.join(QLatin1Char('\n'));
+}
+
+int IncrementalRecognizer::reusedLines() const
+{
+  return reusedLines_;
+}
+
+int IncrementalRecognizer::scrollOffset() const
+{
+  return scrollOffset_;
+}
+
+std::vector<IncrementalRecognizer::Line> IncrementalRecognizer::segment(
+    const QImage &image)
+{
+  std::vector<Line> result;
+  if (image.isNull())
+    return result;
+
+  const auto gray = image.convertToFormat(QImage::Format_Grayscale8);
+  const auto width = gray.width();
+
+  auto top = -1;
+  auto lastText = -1;
+  const auto addLine = [&] {
+    const auto bottom = lastText + 1;
+    if (bottom - top >= minHeight) {
+      auto hash = uint(0);
+      for (auto y = top; y < bottom; ++y)
+        hash = qHashBits(gray.constScanLine(y), size_t(width), hash);
+      result.push_back({top, bottom, hash});
+    }
+    top = -1;
+  };
+
+  for (auto y = 0, end = gray.height(); y < end; ++y) {
+    const auto row = gray.constScanLine(y);
+    const auto [min, max] = std::minmax_element(row, row + width);
+    if (*max - *min > minContrast) {
+      if (top < 0)
+        top = y;
+      lastText = y;
+      continue;
+    }
+    if (top >= 0 && y - lastText > maxGap)
+      addLine();
+  }
+  if (top >= 0)
+    addLine();
+
+  return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class QImage;
+
+// Recognizes periodically captured area line by line. Lines are found with
+// horizontal projection and identified by hash of their pixels, so text of
+// lines that are not changed since previous frame (also scrolled ones) is
+// reused and only new lines are passed to OCR.
+class IncrementalRecognizer
+{
+public:
+  struct Line {
+    int top;
+    int bottom;  // exclusive
+    uint hash;
+  };
+  using RecognizeLine = std::function<QString(const QImage& line)>;
+
+  QString recognize(const QImage& image, const RecognizeLine& recognizeLine);
+
+  int reusedLines() const;
+  int scrollOffset() const;
+
+  static std::vector<Line> segment(const QImage& image);
+
+private:
+  std::mutex mutex_;
+  QHash<uint, QString> texts_;
+  std::vector<Line> lines_;
+  int reusedLines_{0};
+  int scrollOffset_{0};
+};
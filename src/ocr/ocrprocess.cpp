@@ -0,0 +1,283 @@
+#include "ocrprocess.h"
+#include "debug.h"
+#include "recognizerworker.h"
+#include "task.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QSharedMemory>
+
+#include <atomic>
+#include <cstring>
+
+namespace
+{
+const auto startTimeoutMs = 10'000;
+const auto stopTimeoutMs = 2'000;
+const auto writeTimeoutMs = 10'000;
+const auto recognizeTimeoutMs = 300'000;  // large documents take a while
+
+QString uniqueName()
+{
+  static std::atomic_int counter{0};
+  return QStringLiteral("screen-translator-ocr-%1-%2")
+      .arg(QCoreApplication::applicationPid())
+      .arg(++counter);
+}
+
+// whole message or null array if connection is lost
+QByteArray readMessage(QLocalSocket &socket, int timeoutMs)
+{
+  QDataStream stream(&socket);
+  QByteArray result;
+  for (;;) {
+    stream.startTransaction();
+    stream >> result;
+    if (stream.commitTransaction())
+      return result;
+    if (!socket.waitForReadyRead(timeoutMs))
+      return {};
+  }
+}
+
+bool writeMessage(QLocalSocket &socket, const QByteArray &message)
+{
+  QDataStream stream(&socket);
+  stream << message;
+  while (socket.bytesToWrite() > 0) {
+    if (!socket.waitForBytesWritten(writeTimeoutMs))
+      return false;
+  }
+  return true;
+}
+
+void writeLayout(QDataStream &stream, const TextLayout &layout)
+{
+  stream << layout.pageSize() << quint32(layout.words().size());
+  for (const auto &word : layout.words()) {
+    stream << word.text << word.rect << word.confidence << word.block
+           << word.paragraph << word.line;
+  }
+}
+
+TextLayout readLayout(QDataStream &stream)
+{
+  QSize pageSize;
+  quint32 count = 0;
+  stream >> pageSize >> count;
+
+  TextLayout result(pageSize);
+  for (auto i = 0u; i < count && stream.status() == QDataStream::Ok; ++i) {
+    LayoutWord word{};
+    stream >> word.text >> word.rect >> word.confidence >> word.block >>
+        word.paragraph >> word.line;
+    result.addWord(word);
+  }
+  return result;
+}
+}  // namespace
+
+OcrProcess::OcrProcess(const QString &tessdataPath)
+  : tessdataPath_(tessdataPath)
+{
+}
+
+OcrProcess::~OcrProcess()
+{
+  stop();
+}
+
+QString OcrProcess::helperArgument()
+{
+  return QStringLiteral("--ocr-helper");
+}
+
+void OcrProcess::recognize(const TaskPtr &task,
+                           const service::ThreadPolicy &policy, int threads)
+{
+  SOFT_ASSERT(task, return );
+  if (!socket_ && !start()) {
+    task->error = QObject::tr("Failed to start recognition process");
+    return;
+  }
+
+  const auto image = task->captured.toImage();
+  if (!shareImage(image)) {
+    task->error =
+        QObject::tr("Failed to pass image to recognition process: %1")
+            .arg(memory_ ? memory_->errorString() : QString());
+    return;
+  }
+
+  QByteArray request;
+  {
+    QDataStream stream(&request, QIODevice::WriteOnly);
+    stream << (image.isNull() ? QString() : memory_->key()) << image.size()
+           << image.bytesPerLine() << int(image.format()) << tessdataPath_
+           << task->imageFile << task->sourceLanguage << task->useFastModel
+           << task->useLanguageModel << task->retryLowConfidence
+           << task->detectOrientation << task->generation
+           << policy.isBackground << policy.maxThreads << policy.avoidFirstCore
+           << threads;
+  }
+
+  QByteArray reply;
+  if (writeMessage(*socket_, request))
+    reply = readMessage(*socket_, recognizeTimeoutMs);
+
+  if (reply.isNull()) {
+    LERROR() << "Recognition process failed" << LARG(process_->exitCode())
+             << LARG(process_->exitStatus());
+    stop();
+    task->error =
+        QObject::tr("Recognition process failed, it will be restarted");
+    return;
+  }
+
+  QDataStream stream(reply);
+  stream >> task->recognized >> task->error >> task->wordAlternatives;
+  task->layout = readLayout(stream);
+}
+
+bool OcrProcess::start()
+{
+  stop();
+
+  server_ = std::make_unique<QLocalServer>();
+  if (!server_->listen(uniqueName())) {
+    LERROR() << "Failed to listen for recognition process"
+             << server_->errorString();
+    stop();
+    return false;
+  }
+
+  process_ = std::make_unique<QProcess>();
+  process_->setProcessChannelMode(QProcess::ForwardedChannels);
+  process_->start(QCoreApplication::applicationFilePath(),
+                  {helperArgument(), server_->fullServerName()});
+  if (!process_->waitForStarted(startTimeoutMs) ||
+      !server_->waitForNewConnection(startTimeoutMs)) {
+    LERROR() << "Failed to start recognition process"
+             << process_->errorString();
+    stop();
+    return false;
+  }
+
+  socket_ = server_->nextPendingConnection();
+  LTRACE() << "Started recognition process" << process_->processId();
+  return socket_ != nullptr;
+}
+
+void OcrProcess::stop()
+{
+  if (socket_)  // helper exits when connection is closed
+    socket_->disconnectFromServer();
+  socket_ = nullptr;
+
+  if (process_ && process_->state() != QProcess::NotRunning &&
+      !process_->waitForFinished(stopTimeoutMs)) {
+    LTRACE() << "Killing recognition process" << process_->processId();
+    process_->kill();
+    process_->waitForFinished(stopTimeoutMs);
+  }
+  process_.reset();
+  server_.reset();
+}
+
+bool OcrProcess::shareImage(const QImage &image)
+{
+  if (image.isNull())
+    return true;
+
+  // keeps the largest one, so same sized captures do not reallocate it
+  const auto size = int(image.sizeInBytes());
+  if (!memory_ || memory_->size() < size) {
+    memory_ = std::make_unique<QSharedMemory>(uniqueName());
+    if (!memory_->create(size))
+      return false;
+  }
+
+  if (!memory_->lock())
+    return false;
+  std::memcpy(memory_->data(), image.constBits(), size_t(size));
+  memory_->unlock();
+  return true;
+}
+
+int OcrProcess::runHelper(const QString &serverName)
+{
+  QLocalSocket socket;
+  socket.connectToServer(serverName);
+  if (!socket.waitForConnected(startTimeoutMs)) {
+    LERROR() << "Failed to connect to" << serverName << socket.errorString();
+    return 1;
+  }
+
+  RecognizeWorker worker;
+  TaskPtr finished;
+  QObject::connect(&worker, &RecognizeWorker::finished,
+                   [&finished](const TaskPtr &task) { finished = task; });
+
+  for (;;) {
+    const auto request = readMessage(socket, -1);
+    if (request.isNull())  // application closed connection or exited
+      break;
+
+    auto task = std::make_shared<Task>();
+    QString key;
+    QSize size;
+    auto bytesPerLine = 0;
+    auto format = 0;
+    QString tessdataPath;
+    service::ThreadPolicy policy;
+    auto threads = 0;
+    {
+      QDataStream stream(request);
+      stream >> key >> size >> bytesPerLine >> format >> tessdataPath >>
+          task->imageFile >> task->sourceLanguage >> task->useFastModel >>
+          task->useLanguageModel >> task->retryLowConfidence >>
+          task->detectOrientation >> task->generation >>
+          policy.isBackground >> policy.maxThreads >> policy.avoidFirstCore >>
+          threads;
+    }
+
+    if (!key.isEmpty()) {
+      QSharedMemory memory(key);
+      if (memory.attach(QSharedMemory::ReadOnly) && memory.lock()) {
+        const QImage shared(static_cast<const uchar *>(memory.constData()),
+                            size.width(), size.height(), bytesPerLine,
+                            QImage::Format(format));
+        task->captured = QPixmap::fromImage(shared);  // deep copy
+        memory.unlock();
+      } else {
+        task->error = QObject::tr("Failed to read shared image: %1")
+                          .arg(memory.errorString());
+      }
+    }
+
+    finished.reset();
+    if (task->isValid()) {
+      // limits of the application worker, so helpers do not oversubscribe
+      worker.setPolicy(policy);
+      if (threads > 0)
+        worker.setThreads(threads);
+      worker.reset(tessdataPath);
+      worker.handle(task);
+    }
+
+    const auto &result = finished ? finished : task;
+    QByteArray reply;
+    {
+      QDataStream stream(&reply, QIODevice::WriteOnly);
+      stream << result->recognized << result->error
+             << result->wordAlternatives;
+      writeLayout(stream, result->layout);
+    }
+    if (!writeMessage(socket, reply))
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "stfwd.h"
+#include "threadscheduling.h"
+
+#include <QString>
+
+class QImage;
+class QLocalServer;
+class QLocalSocket;
+class QProcess;
+class QSharedMemory;
+
+// Recognizes tasks in a helper process, so crash or lack of memory on broken
+// image does not close the application. Helper is the same executable,
+// started with helperArgument, and it is restarted after failure. Images are
+// passed through shared memory, results come back through local socket.
+// Used from single worker thread, every worker has its own helper.
+class OcrProcess
+{
+public:
+  explicit OcrProcess(const QString &tessdataPath);
+  ~OcrProcess();
+
+  // Sets recognition results or error of the task. Helper uses given
+  // scheduling and internal threads, 0 threads means policy limit.
+  void recognize(const TaskPtr &task, const service::ThreadPolicy &policy,
+                 int threads);
+  // Helper frees its memory, it is started again on the next task.
+  void stop();
+
+  static QString helperArgument();
+  static int runHelper(const QString &serverName);
+
+private:
+  bool start();
+  bool shareImage(const QImage &image);
+
+  QString tessdataPath_;
+  std::unique_ptr<QLocalServer> server_;
+  std::unique_ptr<QProcess> process_;
+  QLocalSocket *socket_{nullptr};  // owned by server
+  std::unique_ptr<QSharedMemory> memory_;
+};
@@ -0,0 +1,97 @@
+#include "orientationdetector.h"
+#include "debug.h"
+
+#include <leptonica/allheaders.h>
+#include <tesseract/baseapi.h>
+
+#include <QFile>
+#include <QImage>
+
+namespace
+{
+const auto maxSide = 1200;
+const auto minSide = 32;
+const auto minOrientationConfidence = 7.0f;  // tesseract's default margin
+
+Pix *toGrayPix(const QImage &source)
+{
+  const auto image = source.convertToFormat(QImage::Format_Grayscale8);
+  auto pix = pixCreate(image.width(), image.height(), 8);
+  SOFT_ASSERT(pix, return nullptr);
+
+  const auto wpl = pixGetWpl(pix);
+  auto data = pixGetData(pix);
+  for (auto y = 0, height = image.height(); y < height; ++y) {
+    const auto line = image.constScanLine(y);
+    auto pixLine = data + y * wpl;
+    for (auto x = 0, width = image.width(); x < width; ++x)
+      SET_DATA_BYTE(pixLine, x, line[x]);
+  }
+  return pix;
+}
+}  // namespace
+
+OrientationDetector::OrientationDetector(const QString &tessdataPath)
+{
+  if (!isAvailable(tessdataPath))
+    return;
+
+  engine_ = std::make_unique<tesseract::TessBaseAPI>();
+  const auto result = engine_->Init(qPrintable(tessdataPath), "osd",
+                                    tesseract::OEM_TESSERACT_ONLY);
+  LTRACE() << "Inited OSD engine" << result;
+  if (result != 0) {
+    engine_.reset();
+    return;
+  }
+  engine_->SetPageSegMode(tesseract::PSM_OSD_ONLY);
+}
+
+OrientationDetector::~OrientationDetector() = default;
+
+bool OrientationDetector::isValid() const
+{
+  return engine_.get();
+}
+
+OrientationDetector::Result OrientationDetector::detect(const QImage &image)
+{
+  SOFT_ASSERT(engine_, return {});
+
+  if (image.width() < minSide || image.height() < minSide)
+    return {};
+
+  auto scaled = image;
+  if (image.width() > maxSide || image.height() > maxSide)
+    scaled = image.scaled(maxSide, maxSide, Qt::KeepAspectRatio,
+                          Qt::FastTransformation);
+
+  auto pix = toGrayPix(scaled);
+  SOFT_ASSERT(pix, return {});
+
+  engine_->SetImage(pix);
+
+  Result result;
+  auto degrees = 0;
+  auto confidence = 0.0f;
+  const char *script = nullptr;
+  auto scriptConfidence = 0.0f;
+  if (engine_->DetectOrientationScript(&degrees, &confidence, &script,
+                                       &scriptConfidence)) {
+    LTRACE() << "Detected orientation" << LARG(degrees) << LARG(confidence)
+             << LARG(script) << LARG(scriptConfidence);
+    if (confidence >= minOrientationConfidence)
+      result.rotation = (360 - degrees) % 360;
+    if (script)
+      result.script = QString::fromUtf8(script);
+  }
+
+  engine_->Clear();
+  pixDestroy(&pix);
+  return result;
+}
+
+bool OrientationDetector::isAvailable(const QString &tessdataPath)
+{
+  return QFile::exists(tessdataPath + QLatin1String("/osd.traineddata"));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QString>
+
+#include <memory>
+
+class QImage;
+namespace tesseract
+{
+class TessBaseAPI;
+}
+
+// Cheap orientation and script detection pre-pass (tesseract OSD).
+class OrientationDetector
+{
+public:
+  struct Result {
+    int rotation{0};  // clockwise degrees to make text upright
+    QString script;
+  };
+
+  explicit OrientationDetector(const QString& tessdataPath);
+  ~OrientationDetector();
+
+  bool isValid() const;
+  Result detect(const QImage& image);
+
+  static bool isAvailable(const QString& tessdataPath);
+
+private:
+  std::unique_ptr<tesseract::TessBaseAPI> engine_;
+};
@@ -0,0 +1,33 @@
+#include "parallelismplanner.h"
+
+#include <algorithm>
+
+ParallelismPlanner::ParallelismPlanner(OcrParallelism mode, int threadBudget,
+                                       int maxWorkers)
+  : mode_(mode)
+  , threadBudget_(std::max(threadBudget, 1))
+  , maxWorkers_(std::max(maxWorkers, 1))
+{
+}
+
+ParallelismPlanner::Plan ParallelismPlanner::plan(int pixels, int queued) const
+{
+  const auto parallelTasks =
+      std::min({std::max(queued, 1), maxWorkers_, threadBudget_});
+
+  switch (mode_) {
+    case OcrParallelism::Image: return {1, threadBudget_};
+    case OcrParallelism::Task: return {parallelTasks, 1};
+    case OcrParallelism::Auto: break;
+  }
+
+  // openmp overhead outweighs its gain on small images, so process them
+  // single threaded, but side by side when several are waiting
+  if (pixels < smallImagePixels)
+    return {parallelTasks, 1};
+
+  if (parallelTasks == 1)
+    return {1, threadBudget_};
+
+  return {parallelTasks, std::max(threadBudget_ / parallelTasks, 1)};
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "settings.h"
+
+// Splits thread budget between parallel engines (one image per engine) and
+// internal OpenMP threads of every engine (parts of one image).
+class ParallelismPlanner
+{
+public:
+  struct Plan {
+    int workers;
+    int threadsPerEngine;
+  };
+
+  ParallelismPlanner(OcrParallelism mode, int threadBudget, int maxWorkers);
+
+  Plan plan(int pixels, int queued) const;
+
+  static const int smallImagePixels = 300 * 1000;
+
+private:
+  OcrParallelism mode_;
+  int threadBudget_;
+  int maxWorkers_;
+};
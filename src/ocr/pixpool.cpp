@@ -0,0 +1,98 @@
+#include "pixpool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+const auto minPooledSize = size_t(256 * 1024);  // about 250x250 rgb image
+const auto pageSize = size_t(4096);
+// reused buffer wastes at most quarter of its size
+const auto maxWasteDivisor = size_t(4);
+}  // namespace
+
+PixPool::PixPool(qint64 maxPooledBytes)
+  : maxPooledBytes_(maxPooledBytes)
+{
+}
+
+PixPool::~PixPool()
+{
+  clear();
+}
+
+PixPool &PixPool::instance()
+{
+  // never destroyed, leptonica might free buffers during static destruction
+  static auto result = new PixPool;
+  return *result;
+}
+
+void *PixPool::allocate(size_t size)
+{
+  if (size < minPooledSize)
+    return std::malloc(size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.allocations;
+
+  void *result = nullptr;
+  auto capacity = size;
+  if (const auto it = pooled_.lower_bound(size);
+      it != pooled_.end() && it->first - size <= size / maxWasteDivisor) {
+    capacity = it->first;
+    result = it->second;
+    pooled_.erase(it);
+    stats_.pooledBytes -= qint64(capacity);
+    ++stats_.reused;
+  } else {
+    capacity = (size + pageSize - 1) / pageSize * pageSize;
+    result = std::malloc(capacity);
+    if (!result)
+      return nullptr;
+  }
+
+  used_.emplace(result, capacity);
+  stats_.usedBytes += qint64(capacity);
+  stats_.peakBytes =
+      std::max(stats_.peakBytes, stats_.usedBytes + stats_.pooledBytes);
+  return result;
+}
+
+void PixPool::deallocate(void *data)
+{
+  if (!data)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = used_.find(data);
+  if (it == used_.end()) {  // small one
+    std::free(data);
+    return;
+  }
+
+  const auto capacity = it->second;
+  used_.erase(it);
+  stats_.usedBytes -= qint64(capacity);
+
+  if (stats_.pooledBytes + qint64(capacity) > maxPooledBytes_) {
+    std::free(data);
+    return;
+  }
+  pooled_.emplace(capacity, data);
+  stats_.pooledBytes += qint64(capacity);
+}
+
+void PixPool::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &buffer : pooled_) std::free(buffer.second);
+  pooled_.clear();
+  stats_.pooledBytes = 0;
+}
+
+PixPool::Stats PixPool::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
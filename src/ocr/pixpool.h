@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+// Pool of large image buffers, used as pixel data allocator of leptonica.
+// Freed buffers are kept for following allocations of close size, so
+// preprocessing of same sized captures reuses memory of previous ones
+// instead of requesting tens of megabytes from the system every time.
+// Thread safe, small buffers go directly to the system allocator.
+class PixPool
+{
+public:
+  struct Stats {
+    qint64 allocations;  // large ones
+    qint64 reused;
+    qint64 usedBytes;
+    qint64 pooledBytes;
+    qint64 peakBytes;  // used and pooled
+  };
+
+  explicit PixPool(qint64 maxPooledBytes = 128 * 1024 * 1024);
+  ~PixPool();
+
+  void *allocate(size_t size);
+  void deallocate(void *data);
+  // Frees all pooled buffers.
+  void clear();
+  Stats stats() const;
+
+  static PixPool &instance();
+
+private:
+  qint64 maxPooledBytes_;
+  mutable std::mutex mutex_;
+  std::multimap<size_t, void *> pooled_;
+  std::unordered_map<void *, size_t> used_;
+  Stats stats_{};
+};
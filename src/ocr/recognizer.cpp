@@ -1,30 +1,80 @@
 #include "recognizer.h"
 #include "debug.h"
+#include "incrementalrecognizer.h"
 #include "manager.h"
+#include "memoryregistry.h"
+#include "parallelismplanner.h"
+#include "pixpool.h"
 #include "recognizerworker.h"
 #include "settings.h"
 #include "task.h"
 #include "tesseract.h"
 
 #include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace
+{
+const auto maxWorkers = 4;
+const auto keepWatchedGenerations = 10;
+const auto idleReleaseMs = 60'000;
+}  // namespace
 
 Recognizer::Recognizer(Manager &manager, const Settings &settings)
   : manager_(manager)
   , settings_(settings)
-  , workerThread_(new QThread(this))
+  , idleTimer_(new QTimer(this))
+{
+  qRegisterMetaType<service::ThreadPolicy>();
+  addWorker();
+
+  // preprocessing buffers are kept only while captures follow each other
+  idleTimer_->setSingleShot(true);
+  idleTimer_->setInterval(idleReleaseMs);
+  connect(idleTimer_, &QTimer::timeout,  //
+          this, [this] {
+            emit releaseBuffers();
+            PixPool::instance().clear();
+          });
+}
+
+void Recognizer::addWorker()
 {
+  auto thread = new QThread(this);
   auto worker = new RecognizeWorker;
   connect(this, &Recognizer::reset,  //
           worker, &RecognizeWorker::reset);
-  connect(this, &Recognizer::recognizeImpl,  //
-          worker, &RecognizeWorker::handle);
+  connect(this, &Recognizer::updateHelperProcess,  //
+          worker, &RecognizeWorker::setHelperProcess);
+  connect(this, &Recognizer::updatePolicy,  //
+          worker, &RecognizeWorker::setPolicy);
+  connect(this, &Recognizer::releaseEngines,  //
+          worker, &RecognizeWorker::releaseEngines);
+  connect(this, &Recognizer::releaseBuffers,  //
+          worker, &RecognizeWorker::releaseBuffers);
   connect(worker, &RecognizeWorker::finished,  //
           this, &Recognizer::recognized);
-  connect(workerThread_, &QThread::finished,  //
+  connect(thread, &QThread::finished,  //
           worker, &QObject::deleteLater);
 
-  workerThread_->start();
-  worker->moveToThread(workerThread_);
+  thread->start();
+  worker->moveToThread(thread);
+  workers_.push_back({thread, worker, {}});
+
+  if (settings_.tessdataPath.isEmpty())  // not configured yet
+    return;
+
+  const auto path = settings_.tessdataPath;
+  const auto policy = policy_;
+  const auto inHelper = settings_.ocrInHelperProcess;
+  QMetaObject::invokeMethod(worker, [worker, path, policy, inHelper] {
+    worker->setPolicy(policy);
+    worker->reset(path);
+    worker->setHelperProcess(inHelper);
+  });
+  LTRACE() << "Added recognition worker" << LARG(workers_.size());
 }
 
 void Recognizer::recognize(const TaskPtr &task)
@@ -38,46 +88,197 @@ void Recognizer::recognize(const TaskPtr &task)
     return;
   }
 
-  queue_.push_back(task);
-  if (queue_.size() == 1)
-    processQueue();
+  idleTimer_->stop();
+  order_.add(task);
+  queue_.push_back({task, false, 0, {}});
+  processQueue();
 }
 
 void Recognizer::processQueue()
 {
-  if (queue_.empty())
+  const auto isWaiting = [](const Item &i) { return !i.isStarted; };
+  const auto waiting = std::find_if(queue_.begin(), queue_.end(), isWaiting);
+  if (waiting == queue_.end())
     return;
-  emit recognizeImpl(queue_.front());
+
+  const auto &image = waiting->task->captured;
+  const auto pending = queue_.size();
+
+  ParallelismPlanner planner(settings_.ocrParallelism, threadBudget(),
+                             maxWorkers);
+  const auto plan = planner.plan(image.width() * image.height(), int(pending));
+
+  while (int(workers_.size()) < plan.workers) addWorker();
+
+  for (auto it = waiting, end = queue_.end(); it != end; ++it) {
+    if (it->isStarted)
+      continue;
+
+    const auto idle = std::find_if(
+        workers_.begin(), workers_.begin() + plan.workers,
+        [](const Worker &w) { return !w.task; });
+    if (idle == workers_.begin() + plan.workers)
+      break;
+
+    it->isStarted = true;
+    it->threads = plan.threadsPerEngine;
+    it->timer.start();
+    idle->task = it->task;
+
+    auto worker = idle->worker;
+    const auto task = it->task;
+    const auto threads = plan.threadsPerEngine;
+    const auto lines = task->isWatched ? watchedLines(task) : nullptr;
+    QMetaObject::invokeMethod(worker, [worker, task, threads, lines] {
+      worker->setThreads(threads);
+      worker->handle(task, lines);
+    });
+  }
 }
 
 void Recognizer::recognized(const TaskPtr &task)
 {
-  manager_.recognized(task);
+  for (auto &worker : workers_) {
+    if (worker.task == task)
+      worker.task.reset();
+  }
 
-  SOFT_ASSERT(!queue_.empty(), return );
-  if (queue_.front() == task) {
-    queue_.pop_front();
+  const auto it =
+      std::find_if(queue_.begin(), queue_.end(),
+                   [task](const Item &i) { return i.task == task; });
+  if (it == queue_.end()) {
+    LTRACE() << "Skipping recognition result of cleared queue";
+    processQueue();
+    return;
+  }
+
+  LTRACE() << "Recognized in" << it->timer.elapsed() << "ms"
+           << LARG(it->threads) << LARG(task->captured.size());
+  queue_.erase(it);
+
+  if (!order_.contains(task)) {
+    LTRACE() << "Recognition finished after queue was cleared";
+    manager_.recognized(task);
   } else {
-    LERROR() << "processed not first item in recognition queue";
-    queue_.clear();
+    // keep order of areas of one capture, other captures are not delayed
+    for (const auto &finished : order_.finish(task))
+      manager_.recognized(finished);
   }
+
   processQueue();
+  if (queue_.empty())
+    idleTimer_->start();
+}
+
+std::shared_ptr<IncrementalRecognizer> Recognizer::watchedLines(
+    const TaskPtr &task)
+{
+  // shared by workers, so any of them continues from the last frame
+  const auto rect = QRect(task->capturePoint, task->captured.size());
+  const auto key = QStringLiteral("%1,%2,%3x%4,%5")
+                       .arg(rect.left())
+                       .arg(rect.top())
+                       .arg(rect.width())
+                       .arg(rect.height())
+                       .arg(task->sourceLanguage);
+
+  for (auto it = watched_.begin(), end = watched_.end(); it != end;) {
+    if (it->first != key &&
+        task->generation - it->second.generation >= keepWatchedGenerations)
+      it = watched_.erase(it);
+    else
+      ++it;
+  }
+
+  auto &watched = watched_[key];
+  if (!watched.lines)
+    watched.lines = std::make_shared<IncrementalRecognizer>();
+  watched.generation = task->generation;
+  return watched.lines;
 }
 
 Recognizer::~Recognizer()
 {
-  workerThread_->quit();
+  for (const auto &worker : workers_) worker.thread->quit();
+
   const auto timeoutMs = 2000;
-  if (!workerThread_->wait(timeoutMs)) {
-    LTRACE() << "terminating tesseract thread";
-    workerThread_->terminate();
+  for (const auto &worker : workers_) {
+    if (!worker.thread->wait(timeoutMs)) {
+      LTRACE() << "terminating tesseract thread";
+      worker.thread->terminate();
+    }
   }
 }
 
+qint64 Recognizer::memoryUsage() const
+{
+  auto result = Tesseract::loadedModelsSize();
+  for (const auto &task : order_.tasks())
+    result += service::MemoryRegistry::pixmapBytes(task->captured);
+  return result;
+}
+
+void Recognizer::releaseMemory()
+{
+  emit releaseEngines();
+}
+
 void Recognizer::updateSettings()
 {
   SOFT_ASSERT(!settings_.tessdataPath.isEmpty(), return );
 
-  queue_.clear();
+  // started tasks are passed further when workers report them, waiting ones
+  // are canceled and finished ones are not delayed by the order anymore
+  std::vector<TaskPtr> dropped;
+  for (const auto &task : order_.clear()) {
+    const auto it =
+        std::find_if(queue_.cbegin(), queue_.cend(),
+                     [task](const Item &i) { return i.task == task; });
+    if (it != queue_.cend() && it->isStarted)
+      continue;
+    if (it != queue_.cend())
+      task->error = tr("Recognition canceled by changed settings");
+    dropped.push_back(task);
+  }
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                              [](const Item &i) { return !i.isStarted; }),
+               queue_.end());
+  watched_.clear();
+
+  // pass them after all processing settings are applied
+  QTimer::singleShot(0, this, [this, dropped] {
+    for (const auto &task : dropped) manager_.recognized(task);
+  });
+
   emit reset(settings_.tessdataPath);
+  emit updateHelperProcess(settings_.ocrInHelperProcess);
+
+  policy_.isBackground = settings_.lowPriorityWorkers;
+  policy_.avoidFirstCore = settings_.keepFirstCoreFree;
+  policy_.maxThreads = threadBudget();
+  emit updatePolicy(policy_);
+}
+
+void Recognizer::prewarm()
+{
+  // model loading takes most of the first recognition time
+  if (workers_.empty() || settings_.tessdataPath.isEmpty() ||
+      settings_.sourceLanguage.isEmpty())
+    return;
+
+  const auto worker = workers_.front().worker;
+  const auto language = settings_.sourceLanguage;
+  const auto useFast = settings_.useFastModels;
+  QMetaObject::invokeMethod(worker, [worker, language, useFast] {
+    worker->prewarm(language, useFast);
+  });
+}
+
+int Recognizer::threadBudget() const
+{
+  if (settings_.ocrThreads > 0)
+    return settings_.ocrThreads;
+  // leave a core for capture and representation by default
+  const auto cores = service::ThreadScheduling::coreCount();
+  return std::max(cores - 1, 1);
 }
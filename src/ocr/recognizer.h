@@ -1,10 +1,18 @@
 #pragma once
 
 #include "stfwd.h"
+#include "taskorder.h"
+#include "threadscheduling.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 
 #include <deque>
+#include <map>
+
+class IncrementalRecognizer;
+class QTimer;
+class RecognizeWorker;
 
 class Recognizer : public QObject
 {
@@ -15,17 +23,46 @@ public:
 
   void updateSettings();
   void recognize(const TaskPtr &task);
+  void prewarm();
+  qint64 memoryUsage() const;
+  void releaseMemory();
 
 signals:
-  void recognizeImpl(const TaskPtr &task);
   void reset(const QString &tessdataPath);
+  void updateHelperProcess(bool isOn);
+  void updatePolicy(const service::ThreadPolicy &policy);
+  void releaseEngines();
+  void releaseBuffers();
 
 private:
+  struct Worker {
+    QThread *thread;
+    RecognizeWorker *worker;
+    TaskPtr task;
+  };
+  struct Item {
+    TaskPtr task;
+    bool isStarted;
+    int threads;
+    QElapsedTimer timer;
+  };
+  struct Watched {
+    std::shared_ptr<IncrementalRecognizer> lines;
+    Generation generation;
+  };
+
   void recognized(const TaskPtr &task);
   void processQueue();
+  void addWorker();
+  int threadBudget() const;
+  std::shared_ptr<IncrementalRecognizer> watchedLines(const TaskPtr &task);
 
   Manager &manager_;
   const Settings &settings_;
-  QThread *workerThread_;
-  std::deque<TaskPtr> queue_;
+  std::vector<Worker> workers_;
+  std::deque<Item> queue_;  // waiting and running
+  TaskOrder order_;
+  std::map<QString, Watched> watched_;
+  service::ThreadPolicy policy_;
+  QTimer *idleTimer_;
 };
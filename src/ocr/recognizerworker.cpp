@@ -1,11 +1,58 @@
 #include "recognizerworker.h"
 #include "debug.h"
+#include "imagetiles.h"
+#include "incrementalrecognizer.h"
+#include "ocrprocess.h"
+#include "orientationdetector.h"
 #include "task.h"
 #include "tesseract.h"
+#include "threadscheduling.h"
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+
+namespace
+{
+// results below it are rechecked with best models or other preprocessing
+const auto fallbackConfidence = 70;
+
+QString engineKey(const LanguageId &language, ModelTier tier, bool isVertical,
+                  int slot)
+{
+  auto result = tier == ModelTier::Fast ? language + QLatin1String("/fast")
+                                        : language;
+  if (isVertical)
+    result += QLatin1String("/vert");
+  if (slot > 0)
+    result += QLatin1Char('#') + QString::number(slot);
+  return result;
+}
+
+ModelTier preferredTier(const LanguageId &language, const QString &path,
+                        bool isVertical, bool useFastModel)
+{
+  const auto hasBest =
+      Tesseract::hasModel(language, path, ModelTier::Best, isVertical);
+  const auto hasFast =
+      Tesseract::hasModel(language, path, ModelTier::Fast, isVertical);
+  return hasFast && (useFastModel || !hasBest) ? ModelTier::Fast
+                                               : ModelTier::Best;
+}
+
+// from most to least probable fixes of poor recognition
+const Preprocessing retryLadder[] = {
+    {true, false, 1.0, false},   // light text on dark background
+    {false, false, 2.0, false},  // small fonts
+    {false, true, 1.0, false},   // noisy background
+    {false, false, 1.0, true},   // scattered labels
+};
+}  // namespace
 
 RecognizeWorker::~RecognizeWorker() = default;
 
-void RecognizeWorker::handle(const TaskPtr &task)
+void RecognizeWorker::handle(
+    const TaskPtr &task, const std::shared_ptr<IncrementalRecognizer> &lines)
 {
   SOFT_ASSERT(task, return );
   SOFT_ASSERT(task->isValid(), return );
@@ -14,35 +61,287 @@ void RecognizeWorker::handle(const TaskPtr &task)
   LTRACE() << "Start recognize" << task->captured;
   auto result = task;
 
-  if (!engines_.count(task->sourceLanguage)) {
-    LTRACE() << "Create OCR engine" << task->sourceLanguage;
+  if (process_ && !lines) {  // lines of watched areas are kept here
+    process_->recognize(task, policy_, threads_);
+    emit finished(result);
+    return;
+  }
 
-    auto engine =
-        std::make_unique<Tesseract>(task->sourceLanguage, tessdataPath_);
+  if (lines) {
+    recognizeLines(task, *lines);
+    removeUnused(task->generation);
+    emit finished(result);
+    return;
+  }
 
-    if (!engine->isValid()) {
-      result->error = tr("Failed to init OCR engine: %1").arg(engine->error());
-      emit finished(result);
-      return;
-    }
+  Preprocessing preprocessing;
+  auto isVertical = false;
+  if (task->detectOrientation)
+    detectOrientation(task, preprocessing, isVertical);
+
+  const auto &language = task->sourceLanguage;
+  const auto hasBest =
+      Tesseract::hasModel(language, tessdataPath_, ModelTier::Best, isVertical);
+  const auto tier =
+      preferredTier(language, tessdataPath_, isVertical, task->useFastModel);
+
+  auto engine = this->engine(task, {tier, isVertical});
+  if (!engine) {
+    emit finished(result);
+    return;
+  }
 
-    engines_.emplace(task->sourceLanguage, std::move(engine));
-    LTRACE() << "Added OCR engine" << task->sourceLanguage;
+  if (!task->imageFile.isEmpty() ||
+      ImageTiles::isLarge(task->captured.size())) {
+    recognizeTiles(*engine, result, preprocessing);
+    removeUnused(task->generation);
+    emit finished(result);
+    return;
   }
 
-  auto &engine = engines_[task->sourceLanguage];
-  SOFT_ASSERT(engine->isValid(), return );
+  const auto image = task->captured.toImage();
+  auto confidence = recognize(*engine, result, image, preprocessing);
+  auto resultTier = tier;
+
+  if (tier == ModelTier::Fast && hasBest && confidence < fallbackConfidence) {
+    LTRACE() << "Low confidence of fast model, retry with best"
+             << LARG(confidence);
+    auto best = std::make_shared<Task>(*task);
+    if (auto bestEngine = this->engine(best, {ModelTier::Best, isVertical})) {
+      const auto bestConfidence =
+          recognize(*bestEngine, best, image, preprocessing);
+      if (bestConfidence >= confidence) {
+        *result = *best;
+        confidence = bestConfidence;
+        resultTier = ModelTier::Best;
+      }
+    }
+  }
 
-  result->recognized = engine->recognize(task->captured);
-  if (result->recognized.isEmpty())
-    result->error = engine->error();
+  if (task->retryLowConfidence && confidence < fallbackConfidence)
+    retry(result, image, {resultTier, isVertical}, preprocessing, confidence);
 
-  lastGenerations_[task->sourceLanguage] = task->generation;
   removeUnused(task->generation);
 
   emit finished(result);
 }
 
+void RecognizeWorker::prewarm(const LanguageId &language, bool useFastModel)
+{
+  SOFT_ASSERT(!tessdataPath_.isEmpty(), return );
+  if (process_)  // helper loads models with the first task
+    return;
+  LTRACE() << "Prewarm OCR engine" << language;
+
+  auto task = std::make_shared<Task>();
+  task->sourceLanguage = language;
+  const auto tier = preferredTier(language, tessdataPath_, false, useFastModel);
+  engine(task, {tier, false});
+}
+
+Tesseract *RecognizeWorker::engine(const TaskPtr &task, const Model &model,
+                                   int slot)
+{
+  const auto key =
+      engineKey(task->sourceLanguage, model.tier, model.isVertical, slot);
+  lastGenerations_[key] = task->generation;
+
+  auto &engine = engines_[key];
+  if (engine)
+    return engine.get();
+
+  LTRACE() << "Create OCR engine" << key;
+  auto created = std::make_unique<Tesseract>(
+      task->sourceLanguage, tessdataPath_, model.tier, model.isVertical);
+
+  if (!created->isValid()) {
+    task->error = tr("Failed to init OCR engine: %1").arg(created->error());
+    engines_.erase(key);
+    return nullptr;
+  }
+
+  engine = std::move(created);
+  LTRACE() << "Added OCR engine" << key;
+  return engine.get();
+}
+
+int RecognizeWorker::recognize(Tesseract &engine, const TaskPtr &task,
+                               const QImage &image,
+                               const Preprocessing &preprocessing)
+{
+  engine.setCollectAlternatives(task->useLanguageModel);
+  task->recognized = engine.recognize(image, preprocessing);
+  task->wordAlternatives = engine.alternatives();
+  task->layout = engine.layout();
+  task->error.clear();
+  if (task->recognized.isEmpty()) {
+    task->error = engine.error();
+    return 0;
+  }
+  return engine.confidence();
+}
+
+void RecognizeWorker::recognizeLines(const TaskPtr &task,
+                                     IncrementalRecognizer &lines)
+{
+  // watched areas are recognized often, so prefer speed
+  const auto &language = task->sourceLanguage;
+  const auto tier =
+      Tesseract::hasModel(language, tessdataPath_, ModelTier::Fast)
+          ? ModelTier::Fast
+          : ModelTier::Best;
+  auto engine = this->engine(task, {tier, false});
+  if (!engine)
+    return;
+
+  engine->setCollectAlternatives(task->useLanguageModel);
+  Preprocessing preprocessing;
+  preprocessing.singleLine = true;
+
+  task->wordAlternatives.clear();
+  task->recognized = lines.recognize(
+      task->captured.toImage(), [&](const QImage &line) {
+        const auto text = engine->recognize(line, preprocessing);
+        const auto &alternatives = engine->alternatives();
+        for (auto it = alternatives.cbegin(), end = alternatives.cend();
+             it != end; ++it)
+          task->wordAlternatives.insert(it.key(), it.value());
+        return text;
+      });
+
+  task->error.clear();
+  if (task->recognized.isEmpty())
+    task->error = tr("Failed to recognize text or no text selected");
+}
+
+void RecognizeWorker::recognizeTiles(Tesseract &engine, const TaskPtr &task,
+                                     const Preprocessing &preprocessing)
+{
+  // bands must follow text lines, so whole image is rotated before tiling
+  const auto rotation = preprocessing.rotation;
+  auto tiles = task->imageFile.isEmpty()
+                   ? ImageTiles(task->captured.toImage(), rotation)
+                   : ImageTiles(task->imageFile, rotation);
+  LTRACE() << "Recognize by tiles" << task->imageFile << tiles.size()
+           << LARG(rotation);
+  auto upright = preprocessing;
+  upright.rotation = 0;
+
+  engine.setCollectAlternatives(task->useLanguageModel);
+  QStringList texts;
+  task->wordAlternatives.clear();
+  task->layout = TextLayout(tiles.sourceSize());
+  while (!tiles.atEnd()) {
+    const auto top = tiles.top();
+    const auto tile = tiles.next();
+    if (tile.isNull())
+      break;
+
+    const auto text = engine.recognize(tile, upright);
+    if (!text.isEmpty())
+      texts.append(text);
+    TextLayout part;
+    for (auto word : engine.layout().words()) {
+      word.rect = tiles.toSource(word.rect.translated(0, top));
+      part.addWord(word);
+    }
+    task->layout.append(part, {});
+    const auto &alternatives = engine.alternatives();
+    for (auto it = alternatives.cbegin(), end = alternatives.cend();
+         it != end; ++it)
+      task->wordAlternatives.insert(it.key(), it.value());
+  }
+
+  task->recognized = texts.join(QLatin1Char('\n'));
+  task->error = tiles.error();
+  if (task->recognized.isEmpty() && task->error.isEmpty())
+    task->error = engine.error();
+}
+
+void RecognizeWorker::retry(const TaskPtr &task, const QImage &image,
+                            const Model &model, const Preprocessing &base,
+                            int confidence)
+{
+  // every parallel step uses own engine instance and a part of task threads
+  const auto budget =
+      threads_ > 0 ? threads_ : service::ThreadScheduling::coreCount();
+  const auto width = std::min({budget, 2, int(std::size(retryLadder))});
+  auto policy = policy_;
+  policy.maxThreads = std::max(budget / width, 1);
+
+  std::vector<Tesseract *> engines;
+  for (auto slot = 0; slot < width; ++slot) {
+    auto probe = std::make_shared<Task>(*task);
+    if (auto engine = this->engine(probe, model, slot))
+      engines.push_back(engine);
+  }
+  if (engines.empty())
+    return;
+
+  auto best = task;
+  auto bestConfidence = confidence;
+  const auto steps = int(std::size(retryLadder));
+
+  for (auto step = 0; step < steps; step += int(engines.size())) {
+    struct Attempt {
+      TaskPtr task;
+      std::future<int> confidence;
+    };
+    std::vector<Attempt> attempts;
+
+    for (auto i = 0, end = int(engines.size()); i < end; ++i) {
+      if (step + i >= steps)
+        break;
+      auto attempt = std::make_shared<Task>(*task);
+      auto engine = engines[i];
+      auto preprocessing = retryLadder[step + i];
+      preprocessing.rotation = base.rotation;
+      attempts.push_back(
+          {attempt, std::async(std::launch::async, [=, &image] {
+             service::ThreadScheduling::apply(policy);
+             return recognize(*engine, attempt, image, preprocessing);
+           })});
+    }
+
+    for (auto &attempt : attempts) {
+      const auto attemptConfidence = attempt.confidence.get();
+      LTRACE() << "Retry step confidence" << LARG(attemptConfidence);
+      if (attemptConfidence > bestConfidence) {
+        best = attempt.task;
+        bestConfidence = attemptConfidence;
+      }
+    }
+
+    if (bestConfidence >= fallbackConfidence)
+      break;
+  }
+
+  if (best != task) {
+    LTRACE() << "Retry improved confidence" << LARG(confidence)
+             << LARG(bestConfidence);
+    *task = *best;
+  }
+}
+
+void RecognizeWorker::releaseEngines()
+{
+  // recreated on demand
+  engines_.clear();
+  lastGenerations_.clear();
+  orientation_.reset();
+  if (process_)
+    process_->stop();
+  LTRACE() << "Released OCR engines";
+}
+
+void RecognizeWorker::releaseBuffers()
+{
+  for (auto &engine : engines_) {
+    if (engine.second)
+      engine.second->releaseBuffers();
+  }
+}
+
 void RecognizeWorker::reset(const QString &tessdataPath)
 {
   if (tessdataPath_ == tessdataPath)
@@ -50,9 +349,33 @@ void RecognizeWorker::reset(const QString &tessdataPath)
 
   tessdataPath_ = tessdataPath;
   engines_.clear();
+  orientation_.reset();
+  if (process_)
+    process_ = std::make_unique<OcrProcess>(tessdataPath_);
   LTRACE() << "Cleared OCR engines";
 }
 
+void RecognizeWorker::setHelperProcess(bool isOn)
+{
+  if (bool(process_) == isOn)
+    return;
+
+  process_ = isOn ? std::make_unique<OcrProcess>(tessdataPath_) : nullptr;
+  LTRACE() << "Recognition in helper process" << LARG(isOn);
+}
+
+void RecognizeWorker::setPolicy(const service::ThreadPolicy &policy)
+{
+  policy_ = policy;
+  service::ThreadScheduling::apply(policy_);
+}
+
+void RecognizeWorker::setThreads(int count)
+{
+  threads_ = count;
+  service::ThreadScheduling::setMaxThreads(count);
+}
+
 void RecognizeWorker::removeUnused(Generation current)
 {
   const auto keepGenerations = 10;
@@ -67,3 +390,36 @@ void RecognizeWorker::removeUnused(Generation current)
     it = lastGenerations_.erase(it);
   }
 }
+
+void RecognizeWorker::detectOrientation(const TaskPtr &task,
+                                        Preprocessing &preprocessing,
+                                        bool &isVertical)
+{
+  if (!orientation_)
+    orientation_ = std::make_unique<OrientationDetector>(tessdataPath_);
+  if (!orientation_->isValid())
+    return;
+
+  const auto image = task->captured.toImage();
+  const auto orientation = orientation_->detect(image);
+
+  // vertical CJK lines look like rotated horizontal ones
+  const auto &language = task->sourceLanguage;
+  const auto hasVertical =
+      Tesseract::hasModel(language, tessdataPath_, ModelTier::Best, true) ||
+      Tesseract::hasModel(language, tessdataPath_, ModelTier::Fast, true);
+  const auto isSideways =
+      orientation.rotation == 90 || orientation.rotation == 270;
+  static const QStringList verticalScripts{
+      QStringLiteral("Han"), QStringLiteral("Japanese"),
+      QStringLiteral("Korean"), QStringLiteral("Hangul"),
+      QStringLiteral("Katakana"), QStringLiteral("Hiragana")};
+  const auto isVerticalScript = verticalScripts.contains(orientation.script);
+  if (hasVertical && isSideways && isVerticalScript) {
+    LTRACE() << "Use vertical model" << language << LARG(orientation.script);
+    isVertical = true;
+    return;
+  }
+
+  preprocessing.rotation = orientation.rotation;
+}
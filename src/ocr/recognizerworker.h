@@ -1,10 +1,17 @@
 #pragma once
 
 #include "stfwd.h"
+#include "threadscheduling.h"
 
 #include <QObject>
 
+class IncrementalRecognizer;
+class OcrProcess;
+class OrientationDetector;
+class QImage;
 class Tesseract;
+enum class ModelTier;
+struct Preprocessing;
 
 class RecognizeWorker : public QObject
 {
@@ -12,16 +19,43 @@ class RecognizeWorker : public QObject
 public:
   ~RecognizeWorker();
 
-  void handle(const TaskPtr &task);
+  void handle(const TaskPtr &task,
+              const std::shared_ptr<IncrementalRecognizer> &lines = {});
   void reset(const QString &tessdataPath);
+  void setHelperProcess(bool isOn);
+  void setPolicy(const service::ThreadPolicy &policy);
+  // Limits internal threads of engines, planned for the next task.
+  void setThreads(int count);
+  void prewarm(const LanguageId &language, bool useFastModel);
+  void releaseEngines();
+  void releaseBuffers();
 
 signals:
   void finished(const TaskPtr &task);
 
 private:
+  struct Model {
+    ModelTier tier;
+    bool isVertical;
+  };
+
+  Tesseract *engine(const TaskPtr &task, const Model &model, int slot = 0);
+  int recognize(Tesseract &engine, const TaskPtr &task, const QImage &image,
+                const Preprocessing &preprocessing);
+  void retry(const TaskPtr &task, const QImage &image, const Model &model,
+             const Preprocessing &base, int confidence);
+  void recognizeLines(const TaskPtr &task, IncrementalRecognizer &lines);
+  void recognizeTiles(Tesseract &engine, const TaskPtr &task,
+                      const Preprocessing &preprocessing);
+  void detectOrientation(const TaskPtr &task, Preprocessing &preprocessing,
+                         bool &isVertical);
   void removeUnused(Generation current);
 
   std::map<QString, std::unique_ptr<Tesseract>> engines_;
   std::map<QString, Generation> lastGenerations_;
   QString tessdataPath_;
+  std::unique_ptr<OrientationDetector> orientation_;
+  std::unique_ptr<OcrProcess> process_;
+  service::ThreadPolicy policy_;
+  int threads_{0};  // 0 - no limit
 };
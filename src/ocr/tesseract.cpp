@@ -1,13 +1,20 @@
 #include "tesseract.h"
 #include "debug.h"
 #include "languagecodes.h"
+#include "pixpool.h"
 #include "task.h"
 
 #include <leptonica/allheaders.h>
 #include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
+
+#include <atomic>
+#include <cstring>
 
-#include <QBuffer>
 #include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTransform>
 
 #if defined(Q_OS_LINUX)
 #include <fstream>
@@ -39,16 +46,6 @@ static qint64 getFreeMemory()
 }
 #endif
 
-static Pix *convertImage(const QImage &image)
-{
-  QBuffer buffer;
-  buffer.open(QIODevice::WriteOnly);
-  image.save(&buffer, "BMP");
-  const auto &data = buffer.data();
-  return pixReadMemBmp(reinterpret_cast<const l_uint8 *>(data.constData()),
-                       data.size());
-}
-
 static QImage convertImage(Pix &image)
 {
   l_uint8 *buffer = nullptr;
@@ -90,25 +87,47 @@ static double getScale(Pix *source)
   return scale;
 }
 
-static Pix *prepareImage(const QImage &image)
+// word without surrounding punctuation, tokenized as in n-gram corrector.
+// Empty if punctuation splits it
+static QString wordCore(const QString &text)
+{
+  static const QRegularExpression expression(
+      QStringLiteral("^[^\\w']*([\\w']+)[^\\w']*$"));
+  const auto match = expression.match(text);
+  return match.hasMatch() ? match.captured(1) : QString();
+}
+
+static l_int32 pixelsPerInch(int dotsPerMeter)
 {
-  auto pix = convertImage(image);
-  SOFT_ASSERT(pix, return nullptr);
-  LTRACE() << "Converted Pix" << pix;
+  return l_int32(dotsPerMeter * 0.0254 + 0.5);
+}
 
-  auto gray = pixConvertRGBToGray(pix, 0.0, 0.0, 0.0);
-  LTRACE() << "Created gray Pix" << gray;
+// takes ownership of gray
+static Pix *prepareImage(Pix *gray, const Preprocessing &preprocessing,
+                         double &usedScale)
+{
   SOFT_ASSERT(gray, return nullptr);
-  pixDestroy(&pix);
-  LTRACE() << "Removed converted Pix";
+
+  if (const auto quads = preprocessing.rotation / 90 % 4; quads != 0) {
+    if (auto rotated = pixRotateOrth(gray, quads)) {
+      pixDestroy(&gray);
+      gray = rotated;
+      LTRACE() << "Rotated Pix" << LARG(preprocessing.rotation);
+    }
+  }
 
   auto scaleSource = gray;
   auto scaled = scaleSource;
+  usedScale = 1.0;
 
-  if (const auto scale = getScale(scaleSource); scale > 1.0) {
+  const auto scale =
+      std::max(getScale(scaleSource), 1.0) * preprocessing.scale;
+  if (scale > 1.0) {
     scaled = pixScale(scaleSource, scale, scale);
     LTRACE() << "Scaled Pix for OCR" << LARG(scale) << LARG(scaled);
-    if (!scaled)
+    if (scaled)
+      usedScale = scale;
+    else
       scaled = scaleSource;
   }
 
@@ -117,32 +136,106 @@ static Pix *prepareImage(const QImage &image)
     LTRACE() << "Removed unscaled Pix";
   }
 
+  if (preprocessing.invert) {
+    pixInvert(scaled, scaled);
+    LTRACE() << "Inverted Pix";
+  }
+
+  if (preprocessing.binarize) {
+    Pix *binary = nullptr;
+    const auto tileSize = 2000;  // single tile for screen captures
+    const auto failed = pixOtsuAdaptiveThreshold(
+        scaled, tileSize, tileSize, 0, 0, 0.1f, nullptr, &binary);
+    LTRACE() << "Binarized Pix" << LARG(binary);
+    if (!failed && binary) {
+      pixDestroy(&scaled);
+      scaled = binary;
+    }
+  }
+
   return scaled;
 }
 
+// models are unpacked to memory about their file size
+static std::atomic<qint64> loadedSize{0};
+
 static void cleanupImage(Pix **image)
 {
   pixDestroy(image);
 }
 
-Tesseract::Tesseract(const LanguageId &language, const QString &tessdataPath)
+Tesseract::Tesseract(const LanguageId &language, const QString &tessdataPath,
+                     ModelTier tier, bool isVertical)
+  : tier_(tier)
 {
   SOFT_ASSERT(!tessdataPath.isEmpty(), return );
   SOFT_ASSERT(!language.isEmpty(), return );
 
-  init(language, tessdataPath);
+  auto name = LanguageCodes::tesseract(language);
+  if (isVertical)
+    name += QLatin1String("_vert");
+  init(name, modelsPath(tessdataPath, tier));
+
+  if (engine_) {
+    modelSize_ = QFileInfo(modelsPath(tessdataPath, tier) + QLatin1Char('/') +
+                           name + QLatin1String(".traineddata"))
+                     .size();
+    loadedSize += modelSize_;
+  }
 }
 
-Tesseract::~Tesseract() = default;
+Tesseract::~Tesseract()
+{
+  releaseBuffers();
+  loadedSize -= modelSize_;
+}
+
+Pix *Tesseract::grayImage(const QImage &source)
+{
+  const auto gray = source.convertToFormat(QImage::Format_Grayscale8);
+  const auto width = gray.width();
+  const auto height = gray.height();
+  const auto wordsPerLine = (width + 3) / 4;
+  const auto size = qint64(wordsPerLine) * 4 * height;
+
+  // keeps the largest size, watched areas are recognized without allocation
+  if (!buffer_ || pixGetRefcount(buffer_) > 1 || size > bufferSize_) {
+    releaseBuffers();
+    buffer_ = pixCreateNoInit(width, height, 8);
+    SOFT_ASSERT(buffer_, return nullptr);
+    bufferSize_ = size;
+    LTRACE() << "Created gray Pix buffer" << LARG(bufferSize_);
+  }
 
-void Tesseract::init(const LanguageId &language, const QString &tessdataPath)
+  pixSetDimensions(buffer_, width, height, 8);
+  pixSetWpl(buffer_, wordsPerLine);
+  pixSetResolution(buffer_, pixelsPerInch(source.dotsPerMeterX()),
+                   pixelsPerInch(source.dotsPerMeterY()));
+
+  auto data = reinterpret_cast<uchar *>(pixGetData(buffer_));
+  for (auto y = 0; y < height; ++y)
+    std::memcpy(data + y * wordsPerLine * 4, gray.constScanLine(y), width);
+  pixEndianByteSwap(buffer_);  // leptonica keeps bytes in native words
+
+  return pixClone(buffer_);
+}
+
+void Tesseract::releaseBuffers()
+{
+  if (!buffer_)
+    return;
+  pixDestroy(&buffer_);
+  bufferSize_ = 0;
+  LTRACE() << "Released gray Pix buffer";
+}
+
+void Tesseract::init(const QString &tesseractName, const QString &tessdataPath)
 {
   SOFT_ASSERT(!engine_, return );
 
   engine_ = std::make_unique<tesseract::TessBaseAPI>();
   LTRACE() << "Created Tesseract api" << engine_.get();
 
-  const auto tesseractName = LanguageCodes::tesseract(language);
   auto result =
       engine_->Init(qPrintable(tessdataPath), qPrintable(tesseractName),
                     tesseract::OEM_DEFAULT);
@@ -160,22 +253,36 @@ const QString &Tesseract::error() const
   return error_;
 }
 
+ModelTier Tesseract::tier() const
+{
+  return tier_;
+}
+
+int Tesseract::confidence() const
+{
+  return confidence_;
+}
+
 QStringList Tesseract::availableLanguageNames(const QString &path)
 {
   if (path.isEmpty())
     return {};
 
-  QDir dir(path);
-  if (!dir.exists())
-    return {};
-
   LanguageIds names;
 
-  const auto files = dir.entryList({"*.traineddata"}, QDir::Files);
-  for (const auto &file : files) {
-    const auto lang = file.left(file.indexOf("."));
-    const auto name = LanguageCodes::name(LanguageCodes::idForTesseract(lang));
-    names.append(name);
+  for (const auto tier : {ModelTier::Best, ModelTier::Fast}) {
+    QDir dir(modelsPath(path, tier));
+    if (!dir.exists())
+      continue;
+
+    const auto files = dir.entryList({"*.traineddata"}, QDir::Files);
+    for (const auto &file : files) {
+      const auto lang = file.left(file.indexOf("."));
+      const auto name =
+          LanguageCodes::name(LanguageCodes::idForTesseract(lang));
+      if (!names.contains(name))
+        names.append(name);
+    }
   }
 
   if (names.isEmpty())
@@ -184,20 +291,70 @@ QStringList Tesseract::availableLanguageNames(const QString &path)
   return names;
 }
 
-QString Tesseract::recognize(const QPixmap &source)
+QString Tesseract::modelsPath(const QString &tessdataPath, ModelTier tier)
+{
+  if (tier == ModelTier::Fast)
+    return tessdataPath + QLatin1String("/fast");
+  return tessdataPath;
+}
+
+qint64 Tesseract::loadedModelsSize()
+{
+  return loadedSize;
+}
+
+void Tesseract::usePixPool()
+{
+  setPixMemoryManager(
+      [](size_t size) { return PixPool::instance().allocate(size); },
+      [](void *data) { PixPool::instance().deallocate(data); });
+}
+
+bool Tesseract::hasModel(const LanguageId &language,
+                         const QString &tessdataPath, ModelTier tier,
+                         bool isVertical)
+{
+  auto name = LanguageCodes::tesseract(language);
+  if (isVertical)
+    name += QLatin1String("_vert");
+  return QFile::exists(modelsPath(tessdataPath, tier) + QLatin1Char('/') +
+                       name + QLatin1String(".traineddata"));
+}
+
+QString Tesseract::recognize(const QImage &source,
+                             const Preprocessing &preprocessing)
 {
   SOFT_ASSERT(engine_, return {});
   SOFT_ASSERT(!source.isNull(), return {});
 
   error_.clear();
+  alternatives_.clear();
+  layout_ = TextLayout(source.size());
+  confidence_ = 0;
 
-  Pix *image = prepareImage(source.toImage());
+  auto scale = 1.0;
+  Pix *image = prepareImage(grayImage(source), preprocessing, scale);
   SOFT_ASSERT(image, return {});
   LTRACE() << "Preprocessed Pix for OCR" << image;
+  auto mode = tesseract::PSM_SINGLE_BLOCK;
+  if (preprocessing.singleLine)
+    mode = tesseract::PSM_SINGLE_LINE;
+  else if (preprocessing.sparseText)
+    mode = tesseract::PSM_SPARSE_TEXT;
+  engine_->SetPageSegMode(mode);
   engine_->SetImage(image);
   LTRACE() << "Set Pix to engine";
   char *outText = engine_->GetUTF8Text();
   LTRACE() << "Received recognized text";
+  confidence_ = engine_->MeanTextConf();
+  LTRACE() << "Mean confidence" << confidence_;
+  if (collectAlternatives_) {
+    collectAlternatives();
+    LTRACE() << "Collected alternatives" << LARG(alternatives_.size());
+  }
+  collectLayout(source.size(), QSize(pixGetWidth(image), pixGetHeight(image)),
+                preprocessing, scale);
+  LTRACE() << "Collected layout" << LARG(layout_.words().size());
   engine_->Clear();
   LTRACE() << "Cleared engine";
   cleanupImage(&image);
@@ -216,3 +373,118 @@ bool Tesseract::isValid() const
 {
   return engine_.get();
 }
+
+void Tesseract::setCollectAlternatives(bool isOn)
+{
+  SOFT_ASSERT(engine_, return );
+  if (collectAlternatives_ == isOn)
+    return;
+
+  collectAlternatives_ = isOn;
+  // 2 - per-symbol alternatives for LSTM
+  engine_->SetVariable("lstm_choice_mode", isOn ? "2" : "0");
+}
+
+const QHash<QString, QStringList> &Tesseract::alternatives() const
+{
+  return alternatives_;
+}
+
+const TextLayout &Tesseract::layout() const
+{
+  return layout_;
+}
+
+void Tesseract::collectAlternatives()
+{
+  using Text = std::unique_ptr<char[]>;
+  const auto wordLevel = tesseract::RIL_WORD;
+  const auto symbolLevel = tesseract::RIL_SYMBOL;
+  const auto maxAlternatives = 5;
+  const auto minConfidence = 20.0f;
+
+  std::unique_ptr<tesseract::ResultIterator> it(engine_->GetIterator());
+  if (!it || it->Empty(wordLevel))
+    return;
+
+  do {
+    const auto word = QString::fromUtf8(Text(it->GetUTF8Text(wordLevel)).get());
+    const auto core = wordCore(word);
+    if (core.isEmpty() || alternatives_.contains(core))
+      continue;
+
+    QStringList variants;
+    auto symbolStart = 0;
+    do {
+      const auto symbol =
+          QString::fromUtf8(Text(it->GetUTF8Text(symbolLevel)).get());
+      if (symbolStart + symbol.size() > word.size())
+        break;
+
+      tesseract::ChoiceIterator choice(*it);
+      do {
+        const auto text = QString::fromUtf8(choice.GetUTF8Text());
+        if (text.isEmpty() || text == symbol ||
+            choice.Confidence() < minConfidence)
+          continue;
+        auto variant = word;
+        variant.replace(symbolStart, symbol.size(), text);
+        variant = wordCore(variant);
+        if (!variant.isEmpty() && variant != core &&
+            !variants.contains(variant))
+          variants.append(variant);
+      } while (variants.size() < maxAlternatives && choice.Next());
+
+      symbolStart += symbol.size();
+    } while (!it->IsAtFinalElement(wordLevel, symbolLevel) &&
+             it->Next(symbolLevel));
+
+    if (!variants.isEmpty())
+      alternatives_.insert(core, variants);
+  } while (it->Next(wordLevel));
+}
+
+void Tesseract::collectLayout(const QSize &sourceSize,
+                              const QSize &preparedSize,
+                              const Preprocessing &preprocessing, double scale)
+{
+  using Text = std::unique_ptr<char[]>;
+  const auto wordLevel = tesseract::RIL_WORD;
+
+  std::unique_ptr<tesseract::ResultIterator> it(engine_->GetIterator());
+  if (!it || it->Empty(wordLevel))
+    return;
+
+  // boxes are found in scaled and rotated image
+  const auto transform = QTransform::fromScale(1.0 / scale, 1.0 / scale) *
+                         QTransform().rotate(-preprocessing.rotation);
+  const auto origin =
+      transform.mapRect(QRectF(QPointF(), QSizeF(preparedSize))).topLeft();
+  const auto bounds = QRect(QPoint(), sourceSize);
+
+  auto block = -1;
+  auto paragraph = -1;
+  auto line = -1;
+  do {
+    if (it->IsAtBeginningOf(tesseract::RIL_BLOCK))
+      ++block;
+    if (it->IsAtBeginningOf(tesseract::RIL_PARA))
+      ++paragraph;
+    if (it->IsAtBeginningOf(tesseract::RIL_TEXTLINE))
+      ++line;
+
+    const auto word = QString::fromUtf8(Text(it->GetUTF8Text(wordLevel)).get());
+    auto left = 0, top = 0, right = 0, bottom = 0;
+    if (word.isEmpty() ||
+        !it->BoundingBox(wordLevel, &left, &top, &right, &bottom))
+      continue;
+
+    const auto rect =
+        transform.mapRect(QRectF(left, top, right - left, bottom - top))
+            .translated(-origin)
+            .toAlignedRect()
+            .intersected(bounds);
+    layout_.addWord({word, rect, int(it->Confidence(wordLevel)), block,
+                     paragraph, line});
+  } while (it->Next(wordLevel));
+}
@@ -1,33 +1,82 @@
 #pragma once
 
 #include "stfwd.h"
+#include "textlayout.h"
 
-#include <QString>
+#include <QHash>
+#include <QStringList>
 
 #include <memory>
 
-class QPixmap;
+class QImage;
+struct Pix;
 namespace tesseract
 {
 class TessBaseAPI;
 }
 class Task;
 
+// tessdata_best models are placed in tessdata path, tessdata_fast in "fast"
+// subfolder of it.
+enum class ModelTier { Best, Fast };
+
+// Variations of image preparation to retry poorly recognized images.
+struct Preprocessing {
+  bool invert{false};
+  bool binarize{false};
+  double scale{1.0};  // applied over automatic scale
+  bool sparseText{false};
+  int rotation{0};  // clockwise, multiple of 90
+  bool singleLine{false};
+};
+
 class Tesseract
 {
 public:
-  Tesseract(const LanguageId& language, const QString& tessdataPath);
+  Tesseract(const LanguageId& language, const QString& tessdataPath,
+            ModelTier tier = ModelTier::Best, bool isVertical = false);
   ~Tesseract();
 
-  QString recognize(const QPixmap& source);
+  QString recognize(const QImage& source,
+                    const Preprocessing& preprocessing = {});
   bool isValid() const;
   const QString& error() const;
+  ModelTier tier() const;
+  int confidence() const;
+
+  void setCollectAlternatives(bool isOn);
+  // Variants of recognized words, without surrounding punctuation.
+  const QHash<QString, QStringList>& alternatives() const;
+  // Words of last recognized image.
+  const TextLayout& layout() const;
+  // Frees reused preprocessing buffer, it is allocated again when needed.
+  void releaseBuffers();
 
   static QStringList availableLanguageNames(const QString& path);
+  static QString modelsPath(const QString& tessdataPath, ModelTier tier);
+  static bool hasModel(const LanguageId& language, const QString& tessdataPath,
+                       ModelTier tier, bool isVertical = false);
+  // Approximate memory of all loaded models.
+  static qint64 loadedModelsSize();
+  // Image data of leptonica is allocated from PixPool. Must be called before
+  // any image is created.
+  static void usePixPool();
 
 private:
-  void init(const LanguageId& language, const QString& tessdataPath);
+  void init(const QString& tesseractName, const QString& tessdataPath);
+  Pix* grayImage(const QImage& source);
+  void collectAlternatives();
+  void collectLayout(const QSize& sourceSize, const QSize& preparedSize,
+                     const Preprocessing& preprocessing, double scale);
 
   std::unique_ptr<tesseract::TessBaseAPI> engine_;
   QString error_;
+  ModelTier tier_;
+  int confidence_{0};
+  qint64 modelSize_{0};
+  bool collectAlternatives_{false};
+  QHash<QString, QStringList> alternatives_;
+  TextLayout layout_;
+  Pix* buffer_{nullptr};
+  qint64 bufferSize_{0};
 };
@@ -0,0 +1,330 @@
+#include "textlayout.h"
+
+#include <QHash>
+
+#include <array>
+#include <functional>
+
+namespace
+{
+enum Level { Block, Paragraph, Line, LevelCount };
+
+int levelIndex(const LayoutWord &word, int level)
+{
+  if (level == Block)
+    return word.block;
+  if (level == Paragraph)
+    return word.paragraph;
+  return word.line;
+}
+
+struct Visitor {
+  std::function<void(int level, int index, const QRect &rect)> open;
+  std::function<void(int level)> close;
+  std::function<void(const LayoutWord &word, int index)> word;
+};
+
+// Walks words as a tree of blocks, paragraphs and lines.
+void visit(const std::vector<LayoutWord> &words, const Visitor &visitor)
+{
+  std::array<QHash<int, QRect>, LevelCount> rects;
+  for (const auto &word : words) {
+    for (auto level = 0; level < LevelCount; ++level)
+      rects[level][levelIndex(word, level)] |= word.rect;
+  }
+
+  const LayoutWord *previous = nullptr;
+  for (auto i = 0, end = int(words.size()); i < end; ++i) {
+    const auto &word = words[i];
+    auto changed = 0;
+    if (previous) {
+      changed = LevelCount;
+      for (auto level = 0; level < LevelCount; ++level) {
+        if (levelIndex(word, level) == levelIndex(*previous, level))
+          continue;
+        changed = level;
+        break;
+      }
+      for (auto level = LevelCount - 1; level >= changed; --level)
+        visitor.close(level);
+    }
+
+    for (auto level = changed; level < LevelCount; ++level) {
+      const auto index = levelIndex(word, level);
+      visitor.open(level, index, rects[level][index]);
+    }
+
+    visitor.word(word, i);
+    previous = &word;
+  }
+
+  if (previous) {
+    for (auto level = LevelCount - 1; level >= 0; --level)
+      visitor.close(level);
+  }
+}
+
+QString escaped(const QString &text)
+{
+  return text.toHtmlEscaped();
+}
+
+QString hocrBox(const QRect &rect)
+{
+  return QString("bbox %1 %2 %3 %4")
+      .arg(rect.left())
+      .arg(rect.top())
+      .arg(rect.left() + rect.width())
+      .arg(rect.top() + rect.height());
+}
+
+QString altoBox(const QRect &rect)
+{
+  return QString(R"(HPOS="%1" VPOS="%2" WIDTH="%3" HEIGHT="%4")")
+      .arg(rect.left())
+      .arg(rect.top())
+      .arg(rect.width())
+      .arg(rect.height());
+}
+
+QString hocr(const std::vector<TextLayout> &pages)
+{
+  const std::array<const char *, LevelCount> classes{"ocr_carea", "ocr_par",
+                                                     "ocr_line"};
+  const std::array<const char *, LevelCount> tags{"div", "p", "span"};
+  const std::array<const char *, LevelCount> ids{"block", "par", "line"};
+
+  QString result;
+  result += R"(<?xml version="1.0" encoding="UTF-8"?>
+<!DOCTYPE html PUBLIC "-//W3C//DTD XHTML 1.0 Transitional//EN"
+ "http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd">
+<html xmlns="http://www.w3.org/1999/xhtml">
+<head>
+<title></title>
+<meta http-equiv="Content-Type" content="text/html;charset=utf-8"/>
+<meta name="ocr-system" content="Screen Translator"/>
+<meta name="ocr-capabilities"
+ content="ocr_page ocr_carea ocr_par ocr_line ocrx_word"/>
+</head>
+<body>
+)";
+
+  for (auto page = 1, end = int(pages.size()); page <= end; ++page) {
+    const auto &layout = pages[page - 1];
+    result += QString(R"(<div class="ocr_page" id="page_%1" title="%2">)")
+                  .arg(page)
+                  .arg(hocrBox(QRect(QPoint(), layout.pageSize())));
+    result += '\n';
+
+    Visitor visitor;
+    visitor.open = [&](int level, int index, const QRect &rect) {
+      result += QString(R"(<%1 class="%2" id="%3_%4_%5" title="%6">)")
+                    .arg(tags[level], classes[level], ids[level])
+                    .arg(page)
+                    .arg(index + 1)
+                    .arg(hocrBox(rect));
+      if (level != Line)
+        result += '\n';
+    };
+    visitor.close = [&](int level) {
+      result += QString("</%1>\n").arg(tags[level]);
+    };
+    visitor.word = [&](const LayoutWord &word, int index) {
+      result += QString(R"(<span class="ocrx_word" id="word_%1_%2" )"
+                        R"(title="%3; x_wconf %4">%5</span> )")
+                    .arg(page)
+                    .arg(index + 1)
+                    .arg(hocrBox(word.rect))
+                    .arg(word.confidence)
+                    .arg(escaped(word.text));
+    };
+    visit(layout.words(), visitor);
+
+    result += "</div>\n";
+  }
+
+  result += "</body>\n</html>\n";
+  return result;
+}
+
+QString alto(const std::vector<TextLayout> &pages)
+{
+  QString result;
+  result += R"(<?xml version="1.0" encoding="UTF-8"?>
+<alto xmlns="http://www.loc.gov/standards/alto/ns-v3#">
+<Description>
+<MeasurementUnit>pixel</MeasurementUnit>
+<OCRProcessing ID="OCR_0">
+<ocrProcessingStep>
+<processingSoftware>
+<softwareName>Screen Translator</softwareName>
+</processingSoftware>
+</ocrProcessingStep>
+</OCRProcessing>
+</Description>
+<Layout>
+)";
+
+  for (auto page = 1, end = int(pages.size()); page <= end; ++page) {
+    const auto &layout = pages[page - 1];
+    const auto pageRect = QRect(QPoint(), layout.pageSize());
+    result += QString(R"(<Page ID="page_%1" PHYSICAL_IMG_NR="%1" )"
+                      R"(WIDTH="%2" HEIGHT="%3">)")
+                  .arg(page)
+                  .arg(pageRect.width())
+                  .arg(pageRect.height());
+    result += QString("\n<PrintSpace %1>\n").arg(altoBox(pageRect));
+
+    // alto has no paragraphs, blocks contain lines
+    auto isLineStart = false;
+    Visitor visitor;
+    visitor.open = [&](int level, int index, const QRect &rect) {
+      if (level == Paragraph)
+        return;
+      const auto tag = level == Block ? "TextBlock" : "TextLine";
+      const auto id = level == Block ? "block" : "line";
+      result += QString(R"(<%1 ID="%2_%3_%4" %5>)")
+                    .arg(tag, id)
+                    .arg(page)
+                    .arg(index + 1)
+                    .arg(altoBox(rect));
+      result += '\n';
+      isLineStart = level == Line;
+    };
+    visitor.close = [&](int level) {
+      if (level == Block)
+        result += "</TextBlock>\n";
+      else if (level == Line)
+        result += "</TextLine>\n";
+    };
+    visitor.word = [&](const LayoutWord &word, int index) {
+      if (!isLineStart)
+        result += "<SP/>\n";
+      isLineStart = false;
+      result += QString(R"(<String ID="string_%1_%2" %3 WC="%4" )"
+                        R"(CONTENT="%5"/>)")
+                    .arg(page)
+                    .arg(index + 1)
+                    .arg(altoBox(word.rect))
+                    .arg(word.confidence / 100.0, 0, 'f', 2)
+                    .arg(escaped(word.text));
+      result += '\n';
+    };
+    visit(layout.words(), visitor);
+
+    result += "</PrintSpace>\n</Page>\n";
+  }
+
+  result += "</Layout>\n</alto>\n";
+  return result;
+}
+
+// Same columns as tesseract's tsv output.
+QString tsv(const std::vector<TextLayout> &pages)
+{
+  QString result =
+      "level\tpage_num\tblock_num\tpar_num\tline_num\tword_num\t"
+      "left\ttop\twidth\theight\tconf\ttext\n";
+
+  const auto row = [&result](int level, const std::array<int, 5> &numbers,
+                             const QRect &rect, int confidence,
+                             const QString &text) {
+    result += QString::number(level);
+    for (const auto number : numbers) result += '\t' + QString::number(number);
+    result += QString("\t%1\t%2\t%3\t%4\t%5\t")
+                  .arg(rect.left())
+                  .arg(rect.top())
+                  .arg(rect.width())
+                  .arg(rect.height())
+                  .arg(confidence);
+    result += QString(text).replace('\t', ' ') + '\n';
+  };
+
+  for (auto page = 1, end = int(pages.size()); page <= end; ++page) {
+    const auto &layout = pages[page - 1];
+    // numbers of page, block, paragraph in block, line in paragraph, word
+    std::array<int, 5> numbers{page, 0, 0, 0, 0};
+    row(1, numbers, QRect(QPoint(), layout.pageSize()), -1, {});
+
+    Visitor visitor;
+    visitor.open = [&](int level, int, const QRect &rect) {
+      ++numbers[level + 1];
+      for (auto i = level + 2; i < int(numbers.size()); ++i) numbers[i] = 0;
+      row(level + 2, numbers, rect, -1, {});
+    };
+    visitor.close = [](int) {};
+    visitor.word = [&](const LayoutWord &word, int) {
+      ++numbers.back();
+      row(5, numbers, word.rect, word.confidence, word.text);
+    };
+    visit(layout.words(), visitor);
+  }
+
+  return result;
+}
+}  // namespace
+
+TextLayout::TextLayout(const QSize &pageSize)
+  : pageSize_(pageSize)
+{
+}
+
+const QSize &TextLayout::pageSize() const
+{
+  return pageSize_;
+}
+
+const std::vector<LayoutWord> &TextLayout::words() const
+{
+  return words_;
+}
+
+bool TextLayout::isEmpty() const
+{
+  return words_.empty();
+}
+
+void TextLayout::addWord(const LayoutWord &word)
+{
+  words_.push_back(word);
+}
+
+void TextLayout::append(const TextLayout &other, const QPoint &offset)
+{
+  // keep indexes of other part unique
+  const auto block = words_.empty() ? 0 : words_.back().block + 1;
+  const auto paragraph = words_.empty() ? 0 : words_.back().paragraph + 1;
+  const auto line = words_.empty() ? 0 : words_.back().line + 1;
+
+  words_.reserve(words_.size() + other.words_.size());
+  for (auto word : other.words_) {
+    word.rect.translate(offset);
+    word.block += block;
+    word.paragraph += paragraph;
+    word.line += line;
+    words_.push_back(word);
+  }
+}
+
+QString TextLayout::toString(LayoutFormat format,
+                             const std::vector<TextLayout> &pages)
+{
+  switch (format) {
+    case LayoutFormat::Hocr: return hocr(pages);
+    case LayoutFormat::Alto: return alto(pages);
+    case LayoutFormat::Tsv: return tsv(pages);
+    case LayoutFormat::None: break;
+  }
+  return {};
+}
+
+QString TextLayout::fileExtension(LayoutFormat format)
+{
+  switch (format) {
+    case LayoutFormat::Hocr: return QStringLiteral(".hocr");
+    case LayoutFormat::Alto: return QStringLiteral(".xml");
+    case LayoutFormat::Tsv: return QStringLiteral(".tsv");
+    case LayoutFormat::None: break;
+  }
+  return {};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QRect>
+#include <QString>
+
+#include <vector>
+
+enum class LayoutFormat { None, Hocr, Alto, Tsv };
+
+struct LayoutWord {
+  QString text;
+  QRect rect;  // in recognized image
+  int confidence;
+  // indexes, unique in page, words of one line are adjacent
+  int block;
+  int paragraph;
+  int line;
+};
+
+// Positions of recognized words, collected during the same recognition pass
+// as text. Exported in formats of layout aware tools, so they do not need to
+// recognize image again.
+class TextLayout
+{
+public:
+  explicit TextLayout(const QSize& pageSize = {});
+
+  const QSize& pageSize() const;
+  const std::vector<LayoutWord>& words() const;
+  bool isEmpty() const;
+
+  void addWord(const LayoutWord& word);
+  // Adds words of image part, located at offset.
+  void append(const TextLayout& other, const QPoint& offset);
+
+  static QString toString(LayoutFormat format,
+                          const std::vector<TextLayout>& pages);
+  static QString fileExtension(LayoutFormat format);
+
+private:
+  QSize pageSize_;
+  std::vector<LayoutWord> words_;
+};
@@ -0,0 +1,92 @@
+#include "pipeline.h"
+#include "debug.h"
+#include "task.h"
+
+#include <algorithm>
+
+Pipeline &Pipeline::then(Stage stage)
+{
+  SOFT_ASSERT(stage.run, return *this);
+  stages_.push_back(std::move(stage));
+  return *this;
+}
+
+Pipeline &Pipeline::finally(Handler finish)
+{
+  finish_ = std::move(finish);
+  return *this;
+}
+
+void Pipeline::start(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
+  if (!task->isValid()) {
+    finish(task);
+    return;
+  }
+  runFrom(task, 0);
+}
+
+void Pipeline::startAt(const TaskPtr &task, const QString &stageName)
+{
+  SOFT_ASSERT(task, return );
+  const auto it = std::find_if(
+      stages_.cbegin(), stages_.cend(),
+      [&stageName](const Stage &stage) { return stage.name == stageName; });
+  SOFT_ASSERT(it != stages_.cend(), finish(task); return );
+  if (!task->isValid()) {
+    finish(task);
+    return;
+  }
+  runFrom(task, int(std::distance(stages_.cbegin(), it)));
+}
+
+void Pipeline::advance(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
+  const auto current = task->pipelineStage;
+  SOFT_ASSERT(current >= 0 && current < stageCount(), return );
+
+  if (!task->isValid() && !stages_[current].isOptional) {
+    LTRACE() << "Pipeline stage failed" << stages_[current].name << task;
+    finish(task);
+    return;
+  }
+  runFrom(task, current + 1);
+}
+
+int Pipeline::stageCount() const
+{
+  return int(stages_.size());
+}
+
+QString Pipeline::stageName(const TaskPtr &task) const
+{
+  SOFT_ASSERT(task, return {});
+  const auto current = task->pipelineStage;
+  if (current < 0 || current >= stageCount())
+    return {};
+  return stages_[current].name;
+}
+
+void Pipeline::runFrom(const TaskPtr &task, int index)
+{
+  for (const auto end = stageCount(); index < end; ++index) {
+    const auto &stage = stages_[index];
+    if (stage.isNeeded && !stage.isNeeded(task))
+      continue;
+
+    task->pipelineStage = index;
+    stage.run(task);
+    return;
+  }
+
+  finish(task);
+}
+
+void Pipeline::finish(const TaskPtr &task)
+{
+  task->pipelineStage = -1;
+  SOFT_ASSERT(finish_, return );
+  finish_(task);
+}
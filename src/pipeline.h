@@ -0,0 +1,46 @@
+#pragma once
+
+#include "stfwd.h"
+
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+// Ordered stages of task processing. Every stage runs the task on its own
+// executor (worker threads, web pages, etc) and reports it back with
+// 'advance', possibly asynchronously and out of order with other tasks.
+// Failed task skips remaining stages and goes straight to the finish
+// handler, unless the stage that failed it is optional.
+class Pipeline
+{
+public:
+  using Handler = std::function<void(const TaskPtr &task)>;
+  using Condition = std::function<bool(const TaskPtr &task)>;
+
+  struct Stage {
+    QString name;
+    Handler run;
+    Condition isNeeded{};     // always runs if empty
+    bool isOptional{false};  // its errors do not stop the task
+  };
+
+  Pipeline &then(Stage stage);
+  Pipeline &finally(Handler finish);
+
+  void start(const TaskPtr &task);
+  // Starts processed task again from the given stage, e.g. after its
+  // intermediate result was edited by user.
+  void startAt(const TaskPtr &task, const QString &stageName);
+  void advance(const TaskPtr &task);
+
+  int stageCount() const;
+  QString stageName(const TaskPtr &task) const;
+
+private:
+  void runFrom(const TaskPtr &task, int index);
+  void finish(const TaskPtr &task);
+
+  std::vector<Stage> stages_;
+  Handler finish_;
+};
@@ -2,6 +2,7 @@
 #include "debug.h"
 #include "geometryutils.h"
 #include "manager.h"
+#include "memoryregistry.h"
 #include "resulteditor.h"
 #include "resultwidget.h"
 #include "settings.h"
@@ -13,6 +14,8 @@
 #include <QMouseEvent>
 #include <QScreen>
 
+#include <algorithm>
+
 Representer::Representer(Manager &manager, TrayIcon &tray,
                          const Settings &settings, const CommonModels &models)
   : manager_(manager)
@@ -88,6 +91,27 @@ void Representer::updateSettings()
   for (auto &w : widgets_) w->updateSettings();
 }
 
+qint64 Representer::memoryUsage() const
+{
+  auto result = qint64(0);
+  for (const auto &widget : widgets_) {
+    if (const auto &task = widget->task())
+      result += service::MemoryRegistry::pixmapBytes(task->captured);
+  }
+  return result;
+}
+
+void Representer::releaseMemory()
+{
+  // widgets of last generation are needed to show last result
+  const auto isStale = [this](const std::unique_ptr<ResultWidget> &widget) {
+    return !widget->isVisible() &&
+           (!widget->task() || widget->task()->generation != generation_);
+  };
+  widgets_.erase(std::remove_if(widgets_.begin(), widgets_.end(), isStale),
+                 widgets_.end());
+}
+
 void Representer::clipboardText(const TaskPtr &task)
 {
   if (!task)
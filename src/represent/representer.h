@@ -22,6 +22,8 @@ public:
   bool isVisible() const;
   void hide();
   void updateSettings();
+  qint64 memoryUsage() const;
+  void releaseMemory();
 
   void clipboardText(const TaskPtr &task);
   void clipboardImage(const TaskPtr &task);
@@ -101,10 +101,14 @@ void ResultEditor::recognizeAndTranslate()
 
 void ResultEditor::translate()
 {
+  task_->corrected = recognizedEdit_->toPlainText();
+  if (task_->corrected != task_->recognized)
+    manager_.learnCorrection(task_);
+
   task_->targetLanguage =
       LanguageCodes::idForName(targetLanguage_->currentText());
   task_->translators = settings_.translators;
-  manager_.corrected(task_);
+  manager_.correctedByUser(task_);
   close();
   task_.reset();
 }
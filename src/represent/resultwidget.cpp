@@ -8,13 +8,18 @@
 #include <QApplication>
 #include <QBoxLayout>
 #include <QDesktopWidget>
+#include <QFileDialog>
 #include <QLabel>
 #include <QMenu>
+#include <QMessageBox>
+#include <QMimeData>
 #include <QMouseEvent>
+#include <QTextStream>
 
 ResultWidget::ResultWidget(Manager &manager, Representer &representer,
                            const Settings &settings, QWidget *parent)
   : QFrame(parent)
+  , manager_(manager)
   , representer_(representer)
   , settings_(settings)
   , image_(new QLabel(this))
@@ -51,6 +56,9 @@ ResultWidget::ResultWidget(Manager &manager, Representer &representer,
     auto edit = contextMenu_->addAction(tr("Edit..."));
     connect(edit, &QAction::triggered,  //
             this, &ResultWidget::edit);
+    saveLayout_ = contextMenu_->addAction(tr("Save text layout..."));
+    connect(saveLayout_, &QAction::triggered,  //
+            this, &ResultWidget::saveLayout);
 
     contextMenu_->addSeparator();
 
@@ -63,6 +71,7 @@ ResultWidget::ResultWidget(Manager &manager, Representer &representer,
   }
 
   installEventFilter(this);
+  setAcceptDrops(true);
 
   auto layout = new QVBoxLayout(this);
   layout->addWidget(image_);
@@ -83,10 +92,21 @@ const TaskPtr &ResultWidget::task() const
 
 void ResultWidget::show(const TaskPtr &task)
 {
+  const auto isSameWatched =
+      task->isWatched && task_ && task_->isWatched && isVisible() &&
+      task_->capturePoint == task->capturePoint &&
+      task_->corrected == task->corrected &&
+      task_->translated == task->translated;
   task_ = task;
+  if (isSameWatched)
+    return;
 
+  image_->setVisible(settings_.showCaptured && !task->isWatched &&
+                     !task->captured.isNull());
   image_->setPixmap(task->captured);
 
+  saveLayout_->setEnabled(!task->layout.isEmpty());
+
   recognized_->setText(task->corrected);
   const auto tooltip = task->recognized == task->corrected
                            ? ""
@@ -112,11 +132,22 @@ void ResultWidget::show(const TaskPtr &task)
 
   QDesktopWidget *desktop = QApplication::desktop();
   Q_CHECK_PTR(desktop);
+  const auto screenRect = desktop->screenGeometry(this);
+
+  if (task->isWatched) {
+    // must not cover watched area, otherwise it is captured next time
+    auto rect = QRect(task->capturePoint, size());
+    rect.moveTop(rect.top() + task->captured.height() + lineWidth());
+    if (rect.bottom() > screenRect.bottom())
+      rect.moveBottom(task->capturePoint.y() - lineWidth());
+    move(rect.topLeft());
+    return;  // without activation to keep focus in watched program
+  }
+
   const auto correction =
       QPoint((width() - task->captured.width()) / 2, lineWidth());
   auto rect = QRect(task->capturePoint - correction, size());
 
-  const auto screenRect = desktop->screenGeometry(this);
   const auto shouldTextOnTop = rect.bottom() > screenRect.bottom();
   if (shouldTextOnTop)
     rect.moveBottom(rect.top() + task->captured.height() + lineWidth());
@@ -181,6 +212,34 @@ void ResultWidget::mouseMoveEvent(QMouseEvent *event)
   move(pos() + event->pos() - lastPos_);
 }
 
+void ResultWidget::dragEnterEvent(QDragEnterEvent *event)
+{
+  const auto mime = event->mimeData();
+  if (mime->hasUrls() || mime->hasImage())
+    event->acceptProposedAction();
+}
+
+void ResultWidget::dropEvent(QDropEvent *event)
+{
+  const auto mime = event->mimeData();
+  if (mime->hasImage()) {
+    manager_.recognizeImage(qvariant_cast<QImage>(mime->imageData()));
+    event->acceptProposedAction();
+    return;
+  }
+
+  QStringList files;
+  for (const auto &url : mime->urls()) {
+    if (url.isLocalFile())
+      files.append(url.toLocalFile());
+  }
+  if (files.isEmpty())
+    return;
+
+  manager_.recognizeImages(files);
+  event->acceptProposedAction();
+}
+
 void ResultWidget::edit()
 {
   representer_.edit(task_);
@@ -195,3 +254,29 @@ void ResultWidget::copyImage()
 {
   representer_.clipboardImage(task_);
 }
+
+void ResultWidget::saveLayout()
+{
+  SOFT_ASSERT(task_, return );
+  // in order of LayoutFormat
+  const QStringList filters{tr("hOCR (*.hocr)"), tr("ALTO (*.xml)"),
+                            tr("TSV (*.tsv)")};
+  QString filter;
+  const auto fileName = QFileDialog::getSaveFileName(
+      this, tr("Save text layout"), {}, filters.join(";;"), &filter);
+  if (fileName.isEmpty())
+    return;
+
+  const auto format = LayoutFormat(std::max(filters.indexOf(filter), 0) + 1);
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Text)) {
+    QMessageBox::warning(
+        this, {},
+        tr("Failed to save text layout: %1").arg(file.errorString()));
+    return;
+  }
+
+  QTextStream stream(&file);
+  stream.setCodec("UTF-8");
+  stream << TextLayout::toString(format, {task_->layout});
+}
@@ -4,6 +4,7 @@
 
 #include <QFrame>
 
+class QAction;
 class QLabel;
 class QMenu;
 
@@ -22,12 +23,16 @@ public:
 protected:
   void mousePressEvent(QMouseEvent* event) override;
   void mouseMoveEvent(QMouseEvent* event) override;
+  void dragEnterEvent(QDragEnterEvent* event) override;
+  void dropEvent(QDropEvent* event) override;
 
 private:
   void edit();
   void copyImage();
   void copyText();
+  void saveLayout();
 
+  Manager& manager_;
   Representer& representer_;
   const Settings& settings_;
   TaskPtr task_;
@@ -36,5 +41,6 @@ private:
   QLabel* separator_;
   QLabel* translated_;
   QMenu* contextMenu_;
+  QAction* saveLayout_;
   QPoint lastPos_;
 };
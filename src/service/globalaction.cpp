@@ -1,11 +1,15 @@
 #include "globalaction.h"
 #include "debug.h"
+#include "latencymonitor.h"
 
 #include <QApplication>
 
+#include <algorithm>
+
 namespace service
 {
 QHash<QPair<quint32, quint32>, QAction *> GlobalAction::actions_;
+qint64 GlobalAction::triggerTime_ = 0;
 
 void GlobalAction::init()
 {
@@ -66,22 +70,69 @@ bool GlobalAction::update(QAction *action, const QKeySequence &newShortcut)
   return newShortcut.isEmpty() ? true : makeGlobal(action);
 }
 
+QStringList GlobalAction::update(const Shortcuts &shortcuts)
+{
+  QStringList failed;
+  beginBatch();
+  for (const auto &[action, shortcut] : shortcuts) {
+    if (!update(action, shortcut))
+      failed << shortcut.toString();
+  }
+
+  for (const auto &key : finishBatch()) {
+    if (auto action = actions_.take(key)) {
+      LERROR() << "Failed to register global hotkey:"
+               << LARG(action->shortcut().toString());
+      failed << action->shortcut().toString();
+    }
+  }
+  return failed;
+}
+
 void GlobalAction::triggerHotKey(quint32 nativeKey, quint32 nativeMods)
 {
   QAction *action = actions_.value(qMakePair(nativeKey, nativeMods));
-  if (action && action->isEnabled())
-    action->activate(QAction::Trigger);
+  if (!action || !action->isEnabled())
+    return;
+
+  // handlers are called synchronously
+  triggerTime_ = LatencyMonitor::now();
+  action->activate(QAction::Trigger);
+  triggerTime_ = 0;
+}
+
+qint64 GlobalAction::triggerTime()
+{
+  return triggerTime_;
 }
 }  // namespace service
 
 #ifdef Q_OS_LINUX
 #include <X11/Xlib.h>
+#include <X11/keysym.h>
 #include <xcb/xcb_event.h>
 #include <QX11Info>
 
+#ifdef WITH_XINPUT2
+#include <xcb/xinput.h>
+#include <QSet>
+#endif
+
 namespace service
 {
-static bool error = false;
+namespace
+{
+struct Grab {
+  QPair<quint32, quint32> key;
+  unsigned long firstRequest;
+  unsigned long endRequest;
+};
+}  // namespace
+
+static bool isBatch = false;
+static std::vector<Grab> batchGrabs;
+static std::vector<unsigned long> failedRequests;
+static int (*defaultHandler)(Display *display, XErrorEvent *event) = nullptr;
 
 static int customHandler(Display *display, XErrorEvent *event)
 {
@@ -90,15 +141,166 @@ static int customHandler(Display *display, XErrorEvent *event)
     case BadAccess:
     case BadValue:
     case BadWindow:
-      if (event->request_code == 33 /* X_GrabKey */ ||
-          event->request_code == 34 /* X_UngrabKey */) {
-        error = true;
+      if (event->request_code == 33 /* X_GrabKey */) {
+        failedRequests.push_back(event->serial);
       }
       [[fallthrough]];
     default: return 0;
   }
 }
 
+// Hotkeys must work with any combination of caps, num and scroll locks
+static const std::vector<quint32> &lockMasks()
+{
+  static std::vector<quint32> masks;
+  if (!masks.empty())
+    return masks;
+
+  Display *display = QX11Info::display();
+  quint32 numLock = Mod2Mask;
+  quint32 scrollLock = 0;
+  if (auto map = XGetModifierMapping(display)) {
+    const auto numCode = XKeysymToKeycode(display, XK_Num_Lock);
+    const auto scrollCode = XKeysymToKeycode(display, XK_Scroll_Lock);
+    for (auto i = 0, end = 8 * map->max_keypermod; i < end; ++i) {
+      const auto code = map->modifiermap[i];
+      if (code == 0)
+        continue;
+      const auto mask = quint32(1) << (i / map->max_keypermod);
+      if (code == numCode)
+        numLock = mask;
+      if (code == scrollCode)
+        scrollLock = mask;
+    }
+    XFreeModifiermap(map);
+  }
+
+  const quint32 locks[] = {LockMask, numLock, scrollLock};
+  for (auto subset = 0u; subset < 8u; ++subset) {
+    auto mask = quint32(0);
+    for (auto i = 0u; i < 3u; ++i) {
+      if (subset & (1u << i))
+        mask |= locks[i];
+    }
+    if (std::find(masks.cbegin(), masks.cend(), mask) == masks.cend())
+      masks.push_back(mask);
+  }
+  LTRACE() << "Hotkey lock masks" << LARG(numLock) << LARG(scrollLock);
+  return masks;
+}
+
+static quint32 allLocksMask()
+{
+  auto result = quint32(0);
+  for (const auto mask : lockMasks()) result |= mask;
+  return result;
+}
+
+#ifdef WITH_XINPUT2
+// Fallback for hotkeys, grabbed by other clients. Raw key events are
+// delivered to every listener, so the key is not taken from that client.
+static QSet<QPair<quint32, quint32>> rawHotKeys;
+static int xinputOpcode = -1;  // 0 if unavailable
+
+static bool listenRawKeys()
+{
+  if (xinputOpcode >= 0)
+    return xinputOpcode > 0;
+
+  xinputOpcode = 0;
+  auto connection = QX11Info::connection();
+  const auto extension = xcb_get_extension_data(connection, &xcb_input_id);
+  if (!extension || !extension->present)
+    return false;
+
+  // raw events are delivered regardless of grabs since 2.1
+  auto version = xcb_input_xi_query_version_reply(
+      connection, xcb_input_xi_query_version(connection, 2, 1), nullptr);
+  const auto isSupported =
+      version && (version->major_version > 2 ||
+                  (version->major_version == 2 && version->minor_version >= 1));
+  free(version);
+  if (!isSupported)
+    return false;
+
+  struct {
+    xcb_input_event_mask_t header;
+    uint32_t mask;
+  } mask;
+  mask.header.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+  mask.header.mask_len = 1;
+  mask.mask = XCB_INPUT_XI_EVENT_MASK_RAW_KEY_PRESS;
+  xcb_input_xi_select_events(connection, QX11Info::appRootWindow(), 1,
+                             &mask.header);
+  xinputOpcode = extension->major_opcode;
+  LTRACE() << "Listening raw key events";
+  return true;
+}
+
+static bool isRawKeyPress(const xcb_generic_event_t *event)
+{
+  if (xinputOpcode <= 0 ||
+      (event->response_type & ~0x80) != XCB_GE_GENERIC)
+    return false;
+  const auto raw =
+      reinterpret_cast<const xcb_input_raw_key_press_event_t *>(event);
+  return raw->extension == xinputOpcode &&
+         raw->event_type == XCB_INPUT_RAW_KEY_PRESS;
+}
+#endif
+
+void GlobalAction::beginBatch()
+{
+  if (isBatch)
+    return;
+  isBatch = true;
+  batchGrabs.clear();
+  failedRequests.clear();
+  defaultHandler = XSetErrorHandler(customHandler);
+}
+
+QList<QPair<quint32, quint32>> GlobalAction::finishBatch()
+{
+  if (!isBatch)
+    return {};
+
+  // single round-trip for all grabs of the batch
+  Display *display = QX11Info::display();
+  XSync(display, False);
+  XSetErrorHandler(defaultHandler);
+  isBatch = false;
+
+  QList<QPair<quint32, quint32>> failed;
+  for (const auto &grab : batchGrabs) {
+    const auto isFailed = std::any_of(
+        failedRequests.cbegin(), failedRequests.cend(), [&grab](auto serial) {
+          return serial >= grab.firstRequest && serial < grab.endRequest;
+        });
+    if (!isFailed || failed.contains(grab.key))
+      continue;
+
+    // drop partially succeeded grabs
+    Window window = QX11Info::appRootWindow();
+    for (const auto lock : lockMasks())
+      XUngrabKey(display, grab.key.first, grab.key.second | lock, window);
+
+#ifdef WITH_XINPUT2
+    if (listenRawKeys()) {
+      LTRACE() << "Hotkey is grabbed by other client, use raw events"
+               << LARG(grab.key.first) << LARG(grab.key.second);
+      rawHotKeys.insert(grab.key);
+      continue;
+    }
+#endif
+    failed.append(grab.key);
+  }
+
+  XFlush(display);
+  batchGrabs.clear();
+  failedRequests.clear();
+  return failed;
+}
+
 bool GlobalAction::registerHotKey(quint32 nativeKey, quint32 nativeMods)
 {
   Display *display = QX11Info::display();
@@ -106,31 +308,36 @@ bool GlobalAction::registerHotKey(quint32 nativeKey, quint32 nativeMods)
   Bool owner = True;
   int pointer = GrabModeAsync;
   int keyboard = GrabModeAsync;
-  error = false;
-  int (*handler)(Display * display, XErrorEvent * event) =
-      XSetErrorHandler(customHandler);
-  XGrabKey(display, nativeKey, nativeMods, window, owner, pointer, keyboard);
-  // allow numlock
-  XGrabKey(display, nativeKey, nativeMods | Mod2Mask, window, owner, pointer,
-           keyboard);
-  XSync(display, False);
-  XSetErrorHandler(handler);
-  return !error;
+
+  const auto wasBatch = isBatch;
+  beginBatch();
+  const auto firstRequest = NextRequest(display);
+  for (const auto lock : lockMasks()) {
+    XGrabKey(display, nativeKey, nativeMods | lock, window, owner, pointer,
+             keyboard);
+  }
+  batchGrabs.push_back(
+      {qMakePair(nativeKey, nativeMods), firstRequest, NextRequest(display)});
+  if (wasBatch)
+    return true;
+  return finishBatch().isEmpty();
 }
 
 bool GlobalAction::unregisterHotKey(quint32 nativeKey, quint32 nativeMods)
 {
+#ifdef WITH_XINPUT2
+  if (rawHotKeys.remove(qMakePair(nativeKey, nativeMods)))
+    return true;
+#endif
+
+  // ungrab of not grabbed key is not an error, so no need to wait for reply
   Display *display = QX11Info::display();
   Window window = QX11Info::appRootWindow();
-  error = false;
-  int (*handler)(Display * display, XErrorEvent * event) =
-      XSetErrorHandler(customHandler);
-  XUngrabKey(display, nativeKey, nativeMods, window);
-  // allow numlock
-  XUngrabKey(display, nativeKey, nativeMods | Mod2Mask, window);
-  XSync(display, False);
-  XSetErrorHandler(handler);
-  return !error;
+  for (const auto lock : lockMasks())
+    XUngrabKey(display, nativeKey, nativeMods | lock, window);
+  if (!isBatch)
+    XFlush(display);
+  return true;
 }
 
 bool GlobalAction::nativeEventFilter(const QByteArray &eventType, void *message,
@@ -143,9 +350,35 @@ bool GlobalAction::nativeEventFilter(const QByteArray &eventType, void *message,
     xcb_key_press_event_t *keyEvent =
         static_cast<xcb_key_press_event_t *>(message);
     const quint32 keycode = keyEvent->detail;
-    const quint32 modifiers = keyEvent->state & ~XCB_MOD_MASK_2;
+    const quint32 modifiers = keyEvent->state & ~allLocksMask();
     triggerHotKey(keycode, modifiers);
+    return false;
   }
+
+#ifdef WITH_XINPUT2
+  if (!rawHotKeys.isEmpty() && isRawKeyPress(event)) {
+    const auto raw = static_cast<xcb_input_raw_key_press_event_t *>(message);
+    const quint32 keycode = raw->detail;
+    if (std::none_of(rawHotKeys.cbegin(), rawHotKeys.cend(),
+                     [keycode](const auto &key) {
+                       return key.first == keycode;
+                     }))
+      return false;
+
+    // raw events have no modifiers state
+    auto connection = QX11Info::connection();
+    auto pointer = xcb_query_pointer_reply(
+        connection,
+        xcb_query_pointer(connection, QX11Info::appRootWindow()), nullptr);
+    if (!pointer)
+      return false;
+    const quint32 keyMasks = 0xff;
+    const quint32 modifiers = pointer->mask & keyMasks & ~allLocksMask();
+    free(pointer);
+    if (rawHotKeys.contains(qMakePair(keycode, modifiers)))
+      triggerHotKey(keycode, modifiers);
+  }
+#endif
   return false;
 }
 
@@ -177,6 +410,15 @@ quint32 GlobalAction::nativeModifiers(Qt::KeyboardModifiers modifiers)
 
 namespace service
 {
+void GlobalAction::beginBatch()
+{
+}
+
+QList<QPair<quint32, quint32>> GlobalAction::finishBatch()
+{
+  return {};  // hotkeys are registered without delay
+}
+
 bool GlobalAction::registerHotKey(quint32 nativeKey, quint32 nativeMods)
 {
   return RegisterHotKey(0, nativeMods ^ nativeKey, nativeMods, nativeKey);
@@ -332,6 +574,15 @@ namespace service
 static bool isInited = false;
 static QHash<QPair<quint32, quint32>, EventHotKeyRef> hotkeyRefs;
 
+void GlobalAction::beginBatch()
+{
+}
+
+QList<QPair<quint32, quint32>> GlobalAction::finishBatch()
+{
+  return {};  // hotkeys are registered without delay
+}
+
 struct ActionAdapter {
   static OSStatus macHandler(EventHandlerCallRef /*nextHandler*/,
                              EventRef event, void * /*userData*/)
@@ -5,6 +5,8 @@
 #include <QAbstractNativeEventFilter>
 #include <QAction>
 
+#include <vector>
+
 namespace service
 {
 class GlobalAction : public QAbstractNativeEventFilter
@@ -17,15 +19,26 @@ public:
   static bool makeGlobal(QAction *action);
   static bool removeGlobal(QAction *action);
   static bool update(QAction *action, const QKeySequence &newShortcut);
+  // Time of hotkey press, if called while its action is triggered, else 0.
+  static qint64 triggerTime();
+  using Shortcuts = std::vector<std::pair<QAction *, QKeySequence>>;
+  // Registration is sent to system at once where possible.
+  // Returns shortcuts that failed to register.
+  static QStringList update(const Shortcuts &shortcuts);
 
 private:
   static QHash<QPair<quint32, quint32>, QAction *> actions_;
+  static qint64 triggerTime_;
 
   static quint32 nativeKeycode(Qt::Key key);
   static quint32 nativeModifiers(Qt::KeyboardModifiers modifiers);
   static bool registerHotKey(quint32 nativeKey, quint32 nativeMods);
   static bool unregisterHotKey(quint32 nativeKey, quint32 nativeMods);
   static void triggerHotKey(quint32 nativeKey, quint32 nativeMods);
+  // Registrations between these calls may be reported as successful and
+  // checked later. Returns keys that failed.
+  static void beginBatch();
+  static QList<QPair<quint32, quint32>> finishBatch();
 
   friend struct ActionAdapter;
 };
@@ -0,0 +1,105 @@
+#include "latencymonitor.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace service
+{
+LatencyMonitor::LatencyMonitor(int window)
+  : window_(std::max(window, 1))
+{
+}
+
+void LatencyMonitor::add(const LatencyMarks &marks)
+{
+  if (marks.front() == 0)
+    return;
+
+  // skipped stage takes no time
+  Durations durations{};
+  auto previous = marks.front();
+  for (auto i = 0; i < stageCount; ++i) {
+    const auto current = marks[i + 1] != 0 ? marks[i + 1] : previous;
+    durations[i] = std::max(current - previous, qint64(0));
+    previous = current;
+  }
+
+  samples_.push_back(durations);
+  while (int(samples_.size()) > window_) samples_.pop_front();
+}
+
+int LatencyMonitor::sampleCount() const
+{
+  return int(samples_.size());
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::stage(Stage stage) const
+{
+  return percentiles(stage);
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::total() const
+{
+  return percentiles(-1);
+}
+
+LatencyMonitor::Stage LatencyMonitor::slowestStage() const
+{
+  auto result = Capture;
+  auto slowest = qint64(-1);
+  for (auto i = 0; i < stageCount; ++i) {
+    const auto p95 = percentiles(i).p95;
+    if (p95 <= slowest)
+      continue;
+    slowest = p95;
+    result = Stage(i);
+  }
+  return result;
+}
+
+QString LatencyMonitor::stageName(Stage stage)
+{
+  switch (stage) {
+    case Capture: return QObject::tr("Capture");
+    case Recognition: return QObject::tr("Recognition");
+    case Correction: return QObject::tr("Correction");
+    case Translation: return QObject::tr("Translation");
+    case Display: return QObject::tr("Display");
+  }
+  return {};
+}
+
+qint64 LatencyMonitor::now()
+{
+  QElapsedTimer timer;
+  timer.start();
+  return timer.msecsSinceReference();
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::percentiles(int stage) const
+{
+  if (samples_.empty())
+    return {0, 0};
+
+  std::vector<qint64> values;
+  values.reserve(samples_.size());
+  for (const auto &sample : samples_) {
+    values.push_back(stage < 0 ? std::accumulate(sample.cbegin(),
+                                                 sample.cend(), qint64(0))
+                               : sample[stage]);
+  }
+  std::sort(values.begin(), values.end());
+
+  // nearest rank
+  const auto rank = [&values](int percent) {
+    const auto index = (int(values.size()) * percent + 99) / 100 - 1;
+    return values[std::clamp(index, 0, int(values.size()) - 1)];
+  };
+  return {rank(50), rank(95)};
+}
+
+}  // namespace service
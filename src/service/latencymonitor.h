@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <array>
+#include <deque>
+
+class QString;
+
+namespace service
+{
+// Points of task processing, durations between neighbours are stages.
+enum class LatencyMark {
+  Requested,  // hotkey or menu
+  Captured,
+  Recognized,
+  Corrected,
+  Translated,
+  Shown,
+  Count
+};
+// Monotonic milliseconds, 0 if point was not passed.
+using LatencyMarks = std::array<qint64, size_t(LatencyMark::Count)>;
+
+// Rolling percentiles of durations of last tasks, per stage and in total.
+class LatencyMonitor
+{
+public:
+  enum Stage { Capture, Recognition, Correction, Translation, Display };
+  static const int stageCount = int(LatencyMark::Count) - 1;
+  struct Percentiles {
+    qint64 p50;
+    qint64 p95;
+  };
+
+  explicit LatencyMonitor(int window = 100);
+
+  void add(const LatencyMarks &marks);
+  int sampleCount() const;
+  Percentiles stage(Stage stage) const;
+  Percentiles total() const;
+  Stage slowestStage() const;  // by p95
+
+  static QString stageName(Stage stage);
+  // Shared clock for marks.
+  static qint64 now();
+
+private:
+  using Durations = std::array<qint64, stageCount>;
+  Percentiles percentiles(int stage) const;  // total if -1
+
+  int window_;
+  std::deque<Durations> samples_;
+};
+
+}  // namespace service
@@ -0,0 +1,107 @@
+#include "memoryregistry.h"
+#include "debug.h"
+
+#include <QFile>
+#include <QObject>
+#include <QPixmap>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace service
+{
+void MemoryRegistry::add(const QString &name, const Measure &measure,
+                         qint64 softLimit, const Release &release)
+{
+  SOFT_ASSERT(measure, return );
+  subsystems_.push_back({{name, 0, softLimit, 0}, measure, release});
+}
+
+void MemoryRegistry::update()
+{
+  for (auto &subsystem : subsystems_) {
+    auto &usage = subsystem.usage;
+    usage.bytes = subsystem.measure();
+    if (usage.softLimit <= 0 || usage.bytes <= usage.softLimit ||
+        !subsystem.release)
+      continue;
+
+    LTRACE() << "Release memory of" << usage.name << LARG(usage.bytes)
+             << LARG(usage.softLimit);
+    subsystem.release();
+    ++usage.releaseCount;
+    usage.bytes = subsystem.measure();
+  }
+
+  if (debug::isTrace)
+    LTRACE() << qPrintable(report());
+}
+
+std::vector<MemoryRegistry::Usage> MemoryRegistry::usages() const
+{
+  std::vector<Usage> result;
+  result.reserve(subsystems_.size());
+  for (const auto &subsystem : subsystems_) result.push_back(subsystem.usage);
+  return result;
+}
+
+qint64 MemoryRegistry::total() const
+{
+  auto result = qint64(0);
+  for (const auto &subsystem : subsystems_) result += subsystem.usage.bytes;
+  return result;
+}
+
+QString MemoryRegistry::report() const
+{
+  QStringList lines;
+  for (const auto &subsystem : subsystems_) {
+    const auto &usage = subsystem.usage;
+    auto line = QString("%1: %2").arg(usage.name, sizeString(usage.bytes));
+    if (usage.softLimit > 0) {
+      line += QObject::tr(" (limit %1, released %2 times)")
+                  .arg(sizeString(usage.softLimit))
+                  .arg(usage.releaseCount);
+    }
+    lines.append(line);
+  }
+
+  lines.append(QObject::tr("Accounted: %1").arg(sizeString(total())));
+  const auto resident = processResident();
+  if (resident >= 0)
+    lines.append(QObject::tr("Process: %1").arg(sizeString(resident)));
+  return lines.join('\n');
+}
+
+qint64 MemoryRegistry::processResident()
+{
+#if defined(Q_OS_LINUX)
+  QFile file(QStringLiteral("/proc/self/statm"));
+  if (!file.open(QFile::ReadOnly))
+    return -1;
+  const auto fields = file.readAll().split(' ');
+  if (fields.size() < 2)
+    return -1;
+  return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+  return -1;
+#endif
+}
+
+qint64 MemoryRegistry::pixmapBytes(const QPixmap &pixmap)
+{
+  return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+QString MemoryRegistry::sizeString(qint64 bytes)
+{
+  const auto kb = 1024.0;
+  if (bytes < kb)
+    return QObject::tr("%1 B").arg(bytes);
+  if (bytes < kb * kb)
+    return QObject::tr("%1 KB").arg(bytes / kb, 0, 'f', 1);
+  return QObject::tr("%1 MB").arg(bytes / (kb * kb), 0, 'f', 1);
+}
+
+}  // namespace service
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+class QPixmap;
+
+namespace service
+{
+// Memory, held by subsystems of long running application. Subsystems report
+// their usage with callbacks and are asked to release memory when it exceeds
+// their soft limits.
+class MemoryRegistry
+{
+public:
+  using Measure = std::function<qint64()>;
+  using Release = std::function<void()>;
+  struct Usage {
+    QString name;
+    qint64 bytes;
+    qint64 softLimit;  // 0 if not limited
+    int releaseCount;
+  };
+
+  void add(const QString &name, const Measure &measure, qint64 softLimit = 0,
+           const Release &release = {});
+  // Measures all subsystems and releases memory of ones over their limits.
+  void update();
+
+  std::vector<Usage> usages() const;
+  qint64 total() const;
+  QString report() const;
+
+  // -1 if unknown
+  static qint64 processResident();
+  static qint64 pixmapBytes(const QPixmap &pixmap);
+  static QString sizeString(qint64 bytes);
+
+private:
+  struct Subsystem {
+    Usage usage;
+    Measure measure;
+    Release release;
+  };
+  std::vector<Subsystem> subsystems_;
+};
+
+}  // namespace service
@@ -0,0 +1,109 @@
+#include "threadscheduling.h"
+#include "debug.h"
+
+#include <QThread>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <dlfcn.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace service
+{
+namespace
+{
+#ifdef Q_OS_LINUX
+void setBackground(bool isOn)
+{
+  const auto tid = pid_t(syscall(SYS_gettid));
+
+  // nice and scheduling policy are per thread on linux
+  thread_local auto isOriginalSaved = false;
+  thread_local auto originalNice = 0;
+  if (!isOriginalSaved) {
+    errno = 0;  // -1 is a valid nice value
+    const auto current = getpriority(PRIO_PROCESS, id_t(tid));
+    if (errno == 0)
+      originalNice = current;
+    isOriginalSaved = true;
+  }
+
+  const auto niceValue = isOn ? std::max(originalNice, 10) : originalNice;
+  if (setpriority(PRIO_PROCESS, id_t(tid), niceValue) != 0) {
+    // unprivileged process can not lower nice value back
+    if (isOn)
+      LTRACE() << "Failed to set thread nice value" << LARG(niceValue);
+    else
+      LWARNING() << "Failed to restore thread nice value, it returns to"
+                 << niceValue << "after restart";
+  }
+
+  sched_param param{};
+  if (sched_setscheduler(tid, isOn ? SCHED_BATCH : SCHED_OTHER, &param) != 0)
+    LTRACE() << "Failed to set thread scheduling policy" << LARG(isOn);
+}
+
+void setAvoidFirstCore(bool isOn)
+{
+  const auto cores = ThreadScheduling::coreCount();
+  if (cores < 2)
+    return;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto i = isOn ? 1 : 0; i < cores; ++i) CPU_SET(i, &set);
+
+  if (sched_setaffinity(0, sizeof(set), &set) != 0)
+    LTRACE() << "Failed to set thread affinity" << LARG(isOn);
+}
+#else
+void setBackground(bool isOn)
+{
+  QThread::currentThread()->setPriority(isOn ? QThread::LowPriority
+                                             : QThread::NormalPriority);
+}
+
+void setAvoidFirstCore(bool /*isOn*/)
+{
+}
+#endif
+}  // namespace
+
+void ThreadScheduling::apply(const ThreadPolicy &policy)
+{
+  LTRACE() << "Apply thread policy" << LARG(policy.isBackground)
+           << LARG(policy.maxThreads) << LARG(policy.avoidFirstCore);
+  setBackground(policy.isBackground);
+  setAvoidFirstCore(policy.avoidFirstCore);
+  setMaxThreads(policy.maxThreads);
+}
+
+void ThreadScheduling::setMaxThreads(int count)
+{
+  // libtesseract may be built with or without openmp, so resolve at runtime
+#ifdef Q_OS_LINUX
+  using SetNumThreads = void (*)(int);
+  static const auto setNumThreads = reinterpret_cast<SetNumThreads>(
+      dlsym(RTLD_DEFAULT, "omp_set_num_threads"));
+  if (!setNumThreads)
+    return;
+  const auto threads = count > 0 ? count : coreCount();
+  setNumThreads(threads);
+  LTRACE() << "Set openmp threads" << LARG(threads);
+#else
+  Q_UNUSED(count);
+#endif
+}
+
+int ThreadScheduling::coreCount()
+{
+  return std::max(QThread::idealThreadCount(), 1);
+}
+
+}  // namespace service
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QMetaType>
+
+namespace service
+{
+// Scheduling parameters, applied by a thread to itself.
+struct ThreadPolicy {
+  bool isBackground{false};
+  int maxThreads{0};  // for internal (OpenMP) parallelism, 0 - no limit
+  bool avoidFirstCore{false};
+};
+
+class ThreadScheduling
+{
+public:
+  static void apply(const ThreadPolicy& policy);
+  static void setMaxThreads(int count);
+  static int coreCount();
+};
+
+}  // namespace service
+
+Q_DECLARE_METATYPE(service::ThreadPolicy);
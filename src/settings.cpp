@@ -7,6 +7,8 @@
 #include <QSettings>
 #include <QStandardPaths>
 
+#include <algorithm>
+
 namespace
 {
 const QString iniFileName = "settings.ini";
@@ -17,6 +19,9 @@ const QString qs_repeatCaptureHotkey = "repeatCaptureHotkey";
 const QString qs_repeatHotkey = "repeatHotkey";
 const QString qs_clipboardHotkey = "clipboardHotkey";
 const QString qs_captureLockedHotkey = "captureLockedHotkey";
+const QString qs_watchInterval = "watchInterval";
+const QString qs_latencyBudget = "latencyBudget";
+const QString qs_translateSelectionHotkey = "translateSelectionHotkey";
 const QString qs_resultShowType = "resultShowType";
 const QString qs_proxyType = "proxyType";
 const QString qs_proxyHostName = "proxyHostName";
@@ -30,11 +35,23 @@ const QString qs_showMessageOnStart = "showMessageOnStart";
 
 const QString qs_recogntionGroup = "Recognition";
 const QString qs_ocrLanguage = "language";
+const QString qs_useFastModels = "useFastModels";
+const QString qs_retryLowConfidence = "retryLowConfidence";
+const QString qs_detectOrientation = "detectOrientation";
+const QString qs_ocrThreads = "ocrThreads";
+const QString qs_documentDpi = "documentDpi";
+const QString qs_documentLayout = "documentLayout";
+const QString qs_ocrParallelism = "ocrParallelism";
+const QString qs_lowPriorityWorkers = "lowPriorityWorkers";
+const QString qs_keepFirstCoreFree = "keepFirstCoreFree";
+const QString qs_ocrInHelperProcess = "ocrInHelperProcess";
 
 const QString qs_correctionGroup = "Correction";
 const QString qs_userSubstitutions = "userSubstitutions";
+const QString qs_userSubstitutionTypes = "userSubstitutionTypes";
 const QString qs_useUserSubstitutions = "useUserSubstitutions";
 const QString qs_useHunspell = "useHunspell";
+const QString qs_useLanguageModel = "useLanguageModel";
 
 const QString qs_translationGroup = "Translation";
 const QString qs_doTranslation = "doTranslation";
@@ -42,6 +59,8 @@ const QString qs_ignoreSslErrors = "ignoreSslErrors";
 const QString qs_translationLanguage = "translation_language";
 const QString qs_translationTimeout = "translation_timeout";
 const QString qs_translators = "translators";
+const QString qs_cacheTranslatorPages = "cacheTranslatorPages";
+const QString qs_translatorCacheSize = "translatorCacheSizeMb";
 
 const QString qs_representationGroup = "Representation";
 const QString qs_fontFamily = "fontFamily";
@@ -73,15 +92,28 @@ QStringList packSubstitutions(const Substitutions& source)
   return result;
 }
 
-Substitutions unpackSubstitutions(const QStringList& raw)
+QVariantList packSubstitutionTypes(const Substitutions& source)
+{
+  QVariantList result;
+  for (const auto& i : source) {
+    result << int(i.second.type);
+  }
+  return result;
+}
+
+Substitutions unpackSubstitutions(const QStringList& raw,
+                                  const QVariantList& types)
 {
   const auto count = raw.size();
   if (count < 3)
     return {};
 
   Substitutions result;
-  for (auto i = 0, end = raw.size(); i < end; i += 3) {
-    result.emplace(raw[i], Substitution{raw[i + 1], raw[i + 2]});
+  for (auto i = 0, end = raw.size() - 2; i < end; i += 3) {
+    auto type = SubstitutionType::Text;
+    if (types.size() > i / 3)
+      type = SubstitutionType(std::clamp(types[i / 3].toInt(), 0, 2));
+    result.emplace(raw[i], Substitution{raw[i + 1], raw[i + 2], type});
   }
   return result;
 }
@@ -148,6 +180,9 @@ void Settings::save() const
   settings.setValue(qs_repeatHotkey, showLastHotkey);
   settings.setValue(qs_clipboardHotkey, clipboardHotkey);
   settings.setValue(qs_captureLockedHotkey, captureLockedHotkey);
+  settings.setValue(qs_watchInterval, int(watchInterval.count()));
+  settings.setValue(qs_latencyBudget, int(latencyBudget.count()));
+  settings.setValue(qs_translateSelectionHotkey, translateSelectionHotkey);
 
   settings.setValue(qs_showMessageOnStart, showMessageOnStart);
 
@@ -171,12 +206,25 @@ void Settings::save() const
 
   settings.beginGroup(qs_recogntionGroup);
   settings.setValue(qs_ocrLanguage, sourceLanguage);
+  settings.setValue(qs_useFastModels, useFastModels);
+  settings.setValue(qs_retryLowConfidence, retryLowConfidence);
+  settings.setValue(qs_detectOrientation, detectOrientation);
+  settings.setValue(qs_ocrThreads, ocrThreads);
+  settings.setValue(qs_ocrParallelism, int(ocrParallelism));
+  settings.setValue(qs_documentDpi, documentDpi);
+  settings.setValue(qs_documentLayout, int(documentLayout));
+  settings.setValue(qs_lowPriorityWorkers, lowPriorityWorkers);
+  settings.setValue(qs_keepFirstCoreFree, keepFirstCoreFree);
+  settings.setValue(qs_ocrInHelperProcess, ocrInHelperProcess);
   settings.endGroup();
 
   settings.beginGroup(qs_correctionGroup);
   settings.setValue(qs_useHunspell, useHunspell);
+  settings.setValue(qs_useLanguageModel, useLanguageModel);
   settings.setValue(qs_useUserSubstitutions, useUserSubstitutions);
   settings.setValue(qs_userSubstitutions, packSubstitutions(userSubstitutions));
+  settings.setValue(qs_userSubstitutionTypes,
+                    packSubstitutionTypes(userSubstitutions));
   settings.endGroup();
 
   settings.beginGroup(qs_translationGroup);
@@ -186,6 +234,8 @@ void Settings::save() const
   settings.setValue(qs_translationLanguage, targetLanguage);
   settings.setValue(qs_translationTimeout, int(translationTimeout.count()));
   settings.setValue(qs_translators, translators);
+  settings.setValue(qs_cacheTranslatorPages, cacheTranslatorPages);
+  settings.setValue(qs_translatorCacheSize, translatorCacheSizeMb);
 
   settings.endGroup();
 
@@ -230,6 +280,15 @@ void Settings::load()
       settings.value(qs_clipboardHotkey, clipboardHotkey).toString();
   captureLockedHotkey =
       settings.value(qs_captureLockedHotkey, captureLockedHotkey).toString();
+  translateSelectionHotkey =
+      settings.value(qs_translateSelectionHotkey, translateSelectionHotkey)
+          .toString();
+  watchInterval = std::chrono::milliseconds(std::max(
+      settings.value(qs_watchInterval, int(watchInterval.count())).toInt(),
+      100));
+  latencyBudget = std::chrono::milliseconds(std::max(
+      settings.value(qs_latencyBudget, int(latencyBudget.count())).toInt(),
+      100));
 
   showMessageOnStart =
       settings.value(qs_showMessageOnStart, showMessageOnStart).toBool();
@@ -257,14 +316,35 @@ void Settings::load()
 
   settings.beginGroup(qs_recogntionGroup);
   sourceLanguage = settings.value(qs_ocrLanguage, sourceLanguage).toString();
+  useFastModels = settings.value(qs_useFastModels, useFastModels).toBool();
+  retryLowConfidence =
+      settings.value(qs_retryLowConfidence, retryLowConfidence).toBool();
+  detectOrientation =
+      settings.value(qs_detectOrientation, detectOrientation).toBool();
+  ocrThreads = settings.value(qs_ocrThreads, ocrThreads).toInt();
+  ocrParallelism = OcrParallelism(std::clamp(
+      settings.value(qs_ocrParallelism, int(ocrParallelism)).toInt(), 0, 2));
+  documentDpi = std::clamp(
+      settings.value(qs_documentDpi, documentDpi).toInt(), 72, 600);
+  documentLayout = LayoutFormat(std::clamp(
+      settings.value(qs_documentLayout, int(documentLayout)).toInt(), 0, 3));
+  lowPriorityWorkers =
+      settings.value(qs_lowPriorityWorkers, lowPriorityWorkers).toBool();
+  keepFirstCoreFree =
+      settings.value(qs_keepFirstCoreFree, keepFirstCoreFree).toBool();
+  ocrInHelperProcess =
+      settings.value(qs_ocrInHelperProcess, ocrInHelperProcess).toBool();
   settings.endGroup();
 
   settings.beginGroup(qs_correctionGroup);
   useHunspell = settings.value(qs_useHunspell, useHunspell).toBool();
+  useLanguageModel =
+      settings.value(qs_useLanguageModel, useLanguageModel).toBool();
   useUserSubstitutions =
       settings.value(qs_useUserSubstitutions, useUserSubstitutions).toBool();
   userSubstitutions =
-      unpackSubstitutions(settings.value(qs_userSubstitutions).toStringList());
+      unpackSubstitutions(settings.value(qs_userSubstitutions).toStringList(),
+                          settings.value(qs_userSubstitutionTypes).toList());
   if (userSubstitutions.empty())
     userSubstitutions = loadLegacySubstitutions();
   settings.endGroup();
@@ -282,6 +362,11 @@ void Settings::load()
   translators = settings.value(qs_translators, translators).toStringList();
   if (translators.size() == 1 && translators.first().contains('|'))  // legacy
     translators = translators.first().split('|');
+  cacheTranslatorPages =
+      settings.value(qs_cacheTranslatorPages, cacheTranslatorPages).toBool();
+  translatorCacheSizeMb = std::clamp(
+      settings.value(qs_translatorCacheSize, translatorCacheSizeMb).toInt(), 1,
+      1024);
 
   settings.endGroup();
 
@@ -333,4 +418,11 @@ void Settings::setPortable(bool isPortable)
   tessdataPath = baseDataPath + "/tessdata";
   translatorsDir = baseDataPath + "/translators";
   hunspellDir = baseDataPath + "/hunspell";
+  languageModelsDir = baseDataPath + "/ngrams";
+
+  translatorsCacheDir =
+      (isPortable ? QDir().absolutePath() + "/cache"
+                  : QStandardPaths::writableLocation(
+                        QStandardPaths::CacheLocation)) +
+      "/translators";
 }
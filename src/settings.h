@@ -1,6 +1,7 @@
 #pragma once
 
 #include "stfwd.h"
+#include "textlayout.h"
 
 #include <QColor>
 #include <QDateTime>
@@ -10,9 +11,14 @@
 
 enum class ResultMode { Widget, Tooltip };
 
+enum class OcrParallelism { Auto, Image, Task };
+
+enum class SubstitutionType { Text, Word, Regex };
+
 struct Substitution {
   QString source;
   QString target;
+  SubstitutionType type{SubstitutionType::Text};
 };
 using Substitutions = std::unordered_multimap<LanguageId, Substitution>;
 
@@ -34,6 +40,9 @@ public:
   QString showLastHotkey{"Ctrl+Alt+X"};
   QString clipboardHotkey{"Ctrl+Alt+C"};
   QString captureLockedHotkey{"Ctrl+Alt+Q"};
+  QString translateSelectionHotkey{"Ctrl+Alt+V"};
+  std::chrono::milliseconds watchInterval{1000};
+  std::chrono::milliseconds latencyBudget{1500};  // for p95
 
   bool showMessageOnStart{true};
   bool runAtSystemStart{false};
@@ -52,11 +61,23 @@ public:
   QString hunspellDir;
   Substitutions userSubstitutions;
   bool useUserSubstitutions{true};
+  bool useLanguageModel{false};
+  QString languageModelsDir;
 
   bool writeTrace{false};
 
   QString tessdataPath;
   QString sourceLanguage{"eng"};
+  bool useFastModels{true};
+  bool retryLowConfidence{true};
+  bool detectOrientation{false};
+  int ocrThreads{0};
+  OcrParallelism ocrParallelism{OcrParallelism::Auto};
+  int documentDpi{300};
+  LayoutFormat documentLayout{LayoutFormat::None};
+  bool lowPriorityWorkers{true};
+  bool keepFirstCoreFree{false};
+  bool ocrInHelperProcess{false};
   LanguageIds availableOcrLanguages_;
 
   bool doTranslation{true};
@@ -66,6 +87,9 @@ public:
   std::chrono::seconds translationTimeout{15};
   QString translatorsDir;
   QStringList translators{"google.js"};
+  bool cacheTranslatorPages{false};
+  int translatorCacheSizeMb{50};
+  QString translatorsCacheDir;
 
   ResultMode resultShowType{ResultMode::Widget};  // dialog
   QString fontFamily;
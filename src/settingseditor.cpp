@@ -67,6 +67,9 @@ SettingsEditor::SettingsEditor(Manager &manager, update::Loader &updater)
          "visible. You can make it using the \"Show translator\" entry "
          "in the tray icon's context menu</b>"));
   ui->translateLangCombo->setModel(models_.targetLanguageModel());
+  ui->translatorsCacheSpin->setEnabled(ui->cacheTranslatorsCheck->isChecked());
+  connect(ui->cacheTranslatorsCheck, &QCheckBox::toggled,  //
+          ui->translatorsCacheSpin, &QSpinBox::setEnabled);
 
   // representation
   ui->fontColor->setAutoFillBackground(true);
@@ -151,6 +154,12 @@ Settings SettingsEditor::settings() const
   settings.clipboardHotkey = ui->clipboardEdit->keySequence().toString();
   settings.captureLockedHotkey =
       ui->captureLockedEdit->keySequence().toString();
+  settings.translateSelectionHotkey =
+      ui->translateSelectionEdit->keySequence().toString();
+  settings.watchInterval =
+      std::chrono::milliseconds(ui->watchIntervalSpin->value());
+  settings.latencyBudget =
+      std::chrono::milliseconds(ui->latencyBudgetSpin->value());
 
   settings.showMessageOnStart = ui->showOnStart->isChecked();
   settings.writeTrace = ui->writeTrace->isChecked();
@@ -164,8 +173,19 @@ Settings SettingsEditor::settings() const
 
   settings.sourceLanguage =
       LanguageCodes::idForName(ui->tesseractLangCombo->currentText());
+  settings.useFastModels = ui->useFastModels->isChecked();
+  settings.retryLowConfidence = ui->retryLowConfidence->isChecked();
+  settings.detectOrientation = ui->detectOrientation->isChecked();
+  settings.ocrThreads = ui->ocrThreads->value();
+  settings.ocrParallelism = OcrParallelism(ui->ocrParallelism->currentIndex());
+  settings.documentDpi = ui->documentDpi->value();
+  settings.documentLayout = LayoutFormat(ui->documentLayout->currentIndex());
+  settings.lowPriorityWorkers = ui->lowPriorityWorkers->isChecked();
+  settings.keepFirstCoreFree = ui->keepFirstCoreFree->isChecked();
+  settings.ocrInHelperProcess = ui->ocrInHelperProcess->isChecked();
 
   settings.useHunspell = ui->useHunspell->isChecked();
+  settings.useLanguageModel = ui->useLanguageModel->isChecked();
   settings.useUserSubstitutions = ui->useUserSubstitutions->isChecked();
   settings.userSubstitutions = ui->userSubstitutionsTable->substitutions();
 
@@ -173,6 +193,8 @@ Settings SettingsEditor::settings() const
   settings.ignoreSslErrors = ui->ignoreSslCheck->isChecked();
   settings.translationTimeout =
       std::chrono::seconds(ui->translateTimeoutSpin->value());
+  settings.cacheTranslatorPages = ui->cacheTranslatorsCheck->isChecked();
+  settings.translatorCacheSizeMb = ui->translatorsCacheSpin->value();
   settings.targetLanguage =
       LanguageCodes::idForName(ui->translateLangCombo->currentText());
 
@@ -213,6 +235,10 @@ void SettingsEditor::setSettings(const Settings &settings)
   ui->repeatEdit->setKeySequence(settings.showLastHotkey);
   ui->clipboardEdit->setKeySequence(settings.clipboardHotkey);
   ui->captureLockedEdit->setKeySequence(settings.captureLockedHotkey);
+  ui->translateSelectionEdit->setKeySequence(
+      settings.translateSelectionHotkey);
+  ui->watchIntervalSpin->setValue(settings.watchInterval.count());
+  ui->latencyBudgetSpin->setValue(settings.latencyBudget.count());
 
   ui->showOnStart->setChecked(settings.showMessageOnStart);
   ui->writeTrace->setChecked(settings.writeTrace);
@@ -227,15 +253,29 @@ void SettingsEditor::setSettings(const Settings &settings)
   ui->tessdataPath->setText(settings.tessdataPath);
   ui->tesseractLangCombo->setCurrentText(
       LanguageCodes::name(settings.sourceLanguage));
+  ui->useFastModels->setChecked(settings.useFastModels);
+  ui->retryLowConfidence->setChecked(settings.retryLowConfidence);
+  ui->detectOrientation->setChecked(settings.detectOrientation);
+  ui->ocrThreads->setValue(settings.ocrThreads);
+  ui->ocrParallelism->setCurrentIndex(int(settings.ocrParallelism));
+  ui->documentDpi->setValue(settings.documentDpi);
+  ui->documentLayout->setCurrentIndex(int(settings.documentLayout));
+  ui->lowPriorityWorkers->setChecked(settings.lowPriorityWorkers);
+  ui->keepFirstCoreFree->setChecked(settings.keepFirstCoreFree);
+  ui->ocrInHelperProcess->setChecked(settings.ocrInHelperProcess);
 
   ui->useHunspell->setChecked(settings.useHunspell);
+  ui->useLanguageModel->setChecked(settings.useLanguageModel);
   ui->hunspellDir->setText(settings.hunspellDir);
+  ui->languageModelsDir->setText(settings.languageModelsDir);
   ui->useUserSubstitutions->setChecked(settings.useUserSubstitutions);
   ui->userSubstitutionsTable->setSubstitutions(settings.userSubstitutions);
 
   ui->doTranslationCheck->setChecked(settings.doTranslation);
   ui->ignoreSslCheck->setChecked(settings.ignoreSslErrors);
   ui->translateTimeoutSpin->setValue(settings.translationTimeout.count());
+  ui->cacheTranslatorsCheck->setChecked(settings.cacheTranslatorPages);
+  ui->translatorsCacheSpin->setValue(settings.translatorCacheSizeMb);
   ui->translatorsPath->setText(settings.translatorsDir);
   enabledTranslators_ = settings.translators;
   updateTranslators();
@@ -332,6 +372,7 @@ void SettingsEditor::handlePortableChanged()
   ui->tessdataPath->setText(settings.tessdataPath);
   ui->translatorsPath->setText(settings.translatorsDir);
   ui->hunspellDir->setText(settings.hunspellDir);
+  ui->languageModelsDir->setText(settings.languageModelsDir);
   updateModels(settings.tessdataPath);
   updateTranslators();
 
@@ -78,7 +78,8 @@ SubstitutionsTable::SubstitutionsTable(QWidget *parent)
 {
   setItemDelegate(new SubstitutionDelegate(this));
   setColumnCount(int(Column::Count));
-  setHorizontalHeaderLabels({tr("Language"), tr("Source"), tr("Changed")});
+  setHorizontalHeaderLabels(
+      {tr("Language"), tr("Source"), tr("Changed"), tr("Match")});
   connect(this, &SubstitutionsTable::itemChanged,  //
           this, &SubstitutionsTable::handleItemChange);
 }
@@ -163,6 +164,11 @@ void SubstitutionsTable::addRow(const LanguageId &language,
   setCellWidget(row, int(E::Language), combo);
   setItem(row, int(E::Source), new QTableWidgetItem(substutution.source));
   setItem(row, int(E::Target), new QTableWidgetItem(substutution.target));
+
+  auto typeCombo = new QComboBox(this);
+  typeCombo->addItems({tr("Text"), tr("Whole word"), tr("Regex")});
+  typeCombo->setCurrentIndex(int(substutution.type));
+  setCellWidget(row, int(E::Type), typeCombo);
 }
 
 std::pair<LanguageId, Substitution> SubstitutionsTable::at(int row) const
@@ -188,6 +194,10 @@ std::pair<LanguageId, Substitution> SubstitutionsTable::at(int row) const
   SOFT_ASSERT(targetItem, return {});
   sub.target = targetItem->text();
 
+  auto typeCombo = static_cast<QComboBox *>(cellWidget(row, int(E::Type)));
+  SOFT_ASSERT(typeCombo, return {});
+  sub.type = SubstitutionType(typeCombo->currentIndex());
+
   return std::make_pair(langId, sub);
 }
 
@@ -10,7 +10,7 @@ class SubstitutionsTable : public QTableWidget
 {
   Q_OBJECT
 public:
-  enum class Column { Language = 0, Source, Target, Count };
+  enum class Column { Language = 0, Source, Target, Type, Count };
 
   explicit SubstitutionsTable(QWidget* parent = nullptr);
 
@@ -1,25 +1,47 @@
 #pragma once
 
+#include "latencymonitor.h"
 #include "stfwd.h"
+#include "textlayout.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QPixmap>
 
 class Task
 {
 public:
-  bool isNull() const { return captured.isNull() && !sourceLanguage.isEmpty(); }
+  bool isNull() const
+  {
+    return captured.isNull() && recognized.isEmpty() &&
+           !sourceLanguage.isEmpty();
+  }
   bool isValid() const { return error.isEmpty(); }
+  void mark(service::LatencyMark point)
+  {
+    latency[size_t(point)] = service::LatencyMonitor::now();
+  }
 
   Generation generation{};
+  bool isWatched{false};  // periodic capture of saved area
+  bool isText{false};     // selected text, no image to recognize
 
   QPoint capturePoint;
   QPixmap captured;
+  QString imageFile;  // full image, captured is its preview
+  int documentPage{-1};  // page of recognized pdf document
+  int pipelineStage{-1};  // index of running Pipeline stage
   QString recognized;
   QString corrected;
   QString translated;
 
   bool useHunspell{false};
+  bool useLanguageModel{false};
+  bool useFastModel{false};
+  bool retryLowConfidence{false};
+  bool detectOrientation{false};
+  QHash<QString, QStringList> wordAlternatives;
+  TextLayout layout;  // of recognized, not corrected, words
 
   LanguageId sourceLanguage;
   LanguageId targetLanguage;
@@ -29,6 +51,8 @@ public:
 
   QString error;
   QStringList translatorErrors;
+
+  service::LatencyMarks latency{};
 };
 
 using TaskPtr = std::shared_ptr<Task>;
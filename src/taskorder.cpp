@@ -0,0 +1,73 @@
+#include "taskorder.h"
+#include "debug.h"
+#include "task.h"
+
+#include <algorithm>
+
+void TaskOrder::add(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return );
+  generations_[task->generation].push_back({task, false});
+}
+
+bool TaskOrder::contains(const TaskPtr &task) const
+{
+  SOFT_ASSERT(task, return false);
+  const auto it = generations_.find(task->generation);
+  if (it == generations_.cend())
+    return false;
+  const auto &items = it->second;
+  return std::any_of(items.cbegin(), items.cend(),
+                     [task](const Item &i) { return i.task == task; });
+}
+
+std::vector<TaskPtr> TaskOrder::finish(const TaskPtr &task)
+{
+  SOFT_ASSERT(task, return {});
+  std::vector<TaskPtr> result;
+
+  const auto generation = generations_.find(task->generation);
+  if (generation == generations_.end())
+    return result;
+
+  auto &items = generation->second;
+  const auto it =
+      std::find_if(items.begin(), items.end(),
+                   [task](const Item &i) { return i.task == task; });
+  if (it == items.end())
+    return result;
+
+  it->isFinished = true;
+  while (!items.empty() && items.front().isFinished) {
+    result.push_back(items.front().task);
+    items.pop_front();
+  }
+
+  if (items.empty())
+    generations_.erase(generation);
+  return result;
+}
+
+std::vector<TaskPtr> TaskOrder::clear()
+{
+  auto result = tasks();
+  generations_.clear();
+  return result;
+}
+
+int TaskOrder::size() const
+{
+  auto result = 0;
+  for (const auto &generation : generations_)
+    result += int(generation.second.size());
+  return result;
+}
+
+std::vector<TaskPtr> TaskOrder::tasks() const
+{
+  std::vector<TaskPtr> result;
+  for (const auto &generation : generations_) {
+    for (const auto &item : generation.second) result.push_back(item.task);
+  }
+  return result;
+}
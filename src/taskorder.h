@@ -0,0 +1,31 @@
+#pragma once
+
+#include "stfwd.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+// Reorder buffer for tasks, finished out of order. Tasks are released in
+// the order they were added, but independently for every generation, so a
+// slow task delays only later tasks of its own capture.
+class TaskOrder
+{
+public:
+  void add(const TaskPtr &task);
+  bool contains(const TaskPtr &task) const;
+  // Marks task as finished and returns tasks, that can be passed further.
+  std::vector<TaskPtr> finish(const TaskPtr &task);
+  // Returns all not yet passed tasks in order, finished or not.
+  std::vector<TaskPtr> clear();
+
+  int size() const;
+  std::vector<TaskPtr> tasks() const;
+
+private:
+  struct Item {
+    TaskPtr task;
+    bool isFinished;
+  };
+  std::map<Generation, std::deque<Item>> generations_;
+};
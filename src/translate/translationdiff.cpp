@@ -0,0 +1,142 @@
+#include "translationdiff.h"
+#include "debug.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+const auto minSimilarity = 0.85;  // recognition jitter of few chars
+const auto maxKnown = 500;
+
+QStringList splitLines(const QString &text)
+{
+  QStringList result;
+  for (const auto &line : text.split(QLatin1Char('\n'))) {
+    const auto trimmed = line.trimmed();
+    if (!trimmed.isEmpty())
+      result.append(trimmed);
+  }
+  return result;
+}
+}  // namespace
+
+QString TranslationDiff::changed(const QString &text)
+{
+  lines_.clear();
+  QStringList changed;
+  for (const auto &source : splitLines(text)) {
+    if (const auto translation = find(source)) {
+      lines_.push_back({source, *translation, true});
+      continue;
+    }
+    lines_.push_back({source, {}, false});
+    if (!changed.contains(source))
+      changed.append(source);
+  }
+
+  LTRACE() << "Translation diff" << LARG(lines_.size())
+           << LARG(changed.size());
+  return changed.join(QLatin1Char('\n'));
+}
+
+QString TranslationDiff::apply(const QString &changedTranslation)
+{
+  QStringList changed;
+  for (const auto &line : lines_) {
+    if (!line.isKnown && !changed.contains(line.source))
+      changed.append(line.source);
+  }
+
+  const auto parts = splitLines(changedTranslation);
+  if (parts.size() != changed.size()) {
+    // translator merged or split lines, so they can not be matched with
+    // translations. Show the block once and translate lines again next time
+    LTRACE() << "Translated lines mismatch" << LARG(parts.size())
+             << LARG(changed.size());
+    QStringList result;
+    auto isBlockAdded = false;
+    for (const auto &line : lines_) {
+      if (line.isKnown) {
+        if (!line.translation.isEmpty())
+          result.append(line.translation);
+      } else if (!isBlockAdded) {
+        result.append(changedTranslation.trimmed());
+        isBlockAdded = true;
+      }
+    }
+    return result.join(QLatin1Char('\n'));
+  }
+
+  for (auto i = 0, end = changed.size(); i < end; ++i) {
+    const auto &source = changed[i];
+    if (!translations_.contains(source))
+      order_.push_back(source);
+    translations_.insert(source, parts[i]);
+  }
+
+  while (int(order_.size()) > maxKnown) {
+    translations_.remove(order_.front());
+    order_.pop_front();
+  }
+
+  QStringList result;
+  for (auto &line : lines_) {
+    if (!line.isKnown) {
+      line.translation = translations_.value(line.source);
+      line.isKnown = true;
+    }
+    if (!line.translation.isEmpty())
+      result.append(line.translation);
+  }
+  return result.join(QLatin1Char('\n'));
+}
+
+const QString *TranslationDiff::find(const QString &source) const
+{
+  if (const auto it = translations_.constFind(source);
+      it != translations_.cend())
+    return &it.value();
+
+  const QString *result = nullptr;
+  auto best = minSimilarity;
+  for (auto it = translations_.cbegin(), end = translations_.cend();
+       it != end; ++it) {
+    const auto longest = std::max(source.size(), it.key().size());
+    const auto lengthDiff = std::abs(source.size() - it.key().size());
+    if (lengthDiff > (1.0 - best) * longest)
+      continue;
+
+    const auto current = similarity(source, it.key());
+    if (current < best)
+      continue;
+    best = current;
+    result = &it.value();
+  }
+  return result;
+}
+
+double TranslationDiff::similarity(const QString &left, const QString &right)
+{
+  const auto longest = std::max(left.size(), right.size());
+  if (longest == 0)
+    return 1.0;
+
+  // levenshtein distance with two rows
+  std::vector<int> previous(size_t(right.size()) + 1);
+  std::vector<int> current(previous.size());
+  for (auto j = 0, end = right.size(); j <= end; ++j) previous[j] = j;
+
+  for (auto i = 1, iEnd = left.size(); i <= iEnd; ++i) {
+    current[0] = i;
+    for (auto j = 1, jEnd = right.size(); j <= jEnd; ++j) {
+      const auto substitution = left[i - 1] == right[j - 1] ? 0 : 1;
+      current[j] = std::min({previous[j] + 1, current[j - 1] + 1,
+                             previous[j - 1] + substitution});
+    }
+    std::swap(previous, current);
+  }
+
+  return 1.0 - double(previous.back()) / longest;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QHash>
+#include <QStringList>
+
+#include <deque>
+
+// Matches lines of periodically captured text with already translated lines
+// of previous frames. Matching tolerates small recognition differences, so
+// only really new lines are sent to translators.
+class TranslationDiff
+{
+public:
+  // Lines without known translation, joined with new line. Empty if
+  // everything is known.
+  QString changed(const QString &text);
+  // Stores translation of text, returned by 'changed', and returns
+  // translation of the whole text, passed to it.
+  QString apply(const QString &changedTranslation);
+
+  // Edit distance based, 1 for equal strings.
+  static double similarity(const QString &left, const QString &right);
+
+private:
+  struct Line {
+    QString source;
+    QString translation;
+    bool isKnown;
+  };
+  const QString *find(const QString &source) const;
+
+  std::vector<Line> lines_;
+  QHash<QString, QString> translations_;
+  std::deque<QString> order_;  // oldest known first
+};
@@ -16,6 +16,7 @@
 #include <QTabWidget>
 #include <QTextEdit>
 #include <QToolBar>
+#include <QWebEngineProfile>
 
 #include <unordered_set>
 
@@ -109,15 +110,45 @@ void Translator::translate(const TaskPtr &task)
     return;
   }
 
+  if (task->isWatched) {
+    translateChanged(task);
+    return;
+  }
+
   queue_.push_back(task);
   processQueue();
 }
 
+void Translator::translateChanged(const TaskPtr &task)
+{
+  const auto area = QStringLiteral("%1,%2,%3-%4")
+                        .arg(task->capturePoint.x())
+                        .arg(task->capturePoint.y())
+                        .arg(task->sourceLanguage, task->targetLanguage);
+  auto &diff = diffs_[area];
+
+  const auto changed = diff.changed(task->corrected);
+  if (changed.isEmpty()) {
+    LTRACE() << "No new text in watched area" << area;
+    task->translated = diff.apply({});
+    manager_.translated(task);
+    return;
+  }
+
+  auto part = std::make_shared<Task>(*task);
+  part->corrected = changed;
+  parts_.emplace(part, Part{task, area});
+  queue_.push_back(part);
+  processQueue();
+}
+
 void Translator::updateSettings()
 {
   view_->setPage(nullptr);
   pages_.clear();
   queue_.clear();
+  parts_.clear();
+  diffs_.clear();
   url_->clear();
 
   tabs_->blockSignals(true);
@@ -142,15 +173,55 @@ void Translator::updateSettings()
     return;
   }
 
+  for (auto it = profiles_.begin(); it != profiles_.end();) {
+    if (loaded.count(it->first))
+      ++it;
+    else
+      it = profiles_.erase(it);
+  }
+
   for (const auto &script : loaded) createPage(script.first, script.second);
 }
 
+QWebEngineProfile *Translator::profile(const QString &scriptName)
+{
+  // reused by rebuilt pages, so only one profile works with files on disk
+  const auto path = settings_.cacheTranslatorPages
+                        ? settings_.translatorsCacheDir + QLatin1Char('/') +
+                              scriptName
+                        : QString();
+  const auto cacheSize = qint64(settings_.translatorCacheSizeMb) * 1024 * 1024;
+
+  auto &profile = profiles_[scriptName];
+  if (!profile.profile || profile.path != path) {
+    profile.profile.reset();  // its page is already removed
+    profile.path = path;
+    if (path.isEmpty()) {
+      profile.profile = std::make_unique<QWebEngineProfile>();
+      return profile.profile.get();
+    }
+
+    // separate storage keeps cookies and local data of sites apart
+    const auto name = QLatin1String("translator-") + scriptName;
+    profile.profile = std::make_unique<QWebEngineProfile>(name);
+    profile.profile->setPersistentStoragePath(path + QLatin1String("/storage"));
+    profile.profile->setCachePath(path + QLatin1String("/http"));
+    profile.profile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+    LTRACE() << "Persistent translator profile" << path;
+  }
+
+  if (!path.isEmpty())
+    profile.profile->setHttpCacheMaximumSize(int(cacheSize));
+  return profile.profile.get();
+}
+
 void Translator::createPage(const QString &scriptName,
                             const QString &scriptText)
 {
   pages_.erase(scriptName);
   const auto pageIt = pages_.emplace(
-      scriptName, std::make_unique<WebPage>(*this, scriptText, scriptName));
+      scriptName, std::make_unique<WebPage>(*this, scriptText, scriptName,
+                                            profile(scriptName)));
   SOFT_ASSERT(pageIt.second, return );
 
   const auto &page = pageIt.first->second;
@@ -183,6 +254,25 @@ void Translator::createPage(const QString &scriptName,
   LTRACE() << "Created page" << LARG(scriptName);
 }
 
+qint64 Translator::memoryUsage() const
+{
+  // memory of render processes is not visible from here
+  auto result = qint64(0);
+  for (auto i = 0, end = tabs_->count(); i < end; ++i) {
+    if (auto log = qobject_cast<QTextEdit *>(tabs_->widget(i)))
+      result += log->document()->characterCount() * qint64(sizeof(QChar));
+  }
+  return result;
+}
+
+void Translator::releaseMemory()
+{
+  for (auto i = 0, end = tabs_->count(); i < end; ++i) {
+    if (auto log = qobject_cast<QTextEdit *>(tabs_->widget(i)))
+      log->clear();
+  }
+}
+
 void Translator::showDebugView()
 {
   if (!debugView_)
@@ -295,7 +385,18 @@ void Translator::processQueue()
 
 void Translator::markTranslated(const TaskPtr &task)
 {
-  manager_.translated(task);
+  auto result = task;
+  if (const auto it = parts_.find(task); it != parts_.end()) {
+    result = it->second.whole;
+    result->usedTranslator = task->usedTranslator;
+    result->translatorErrors = task->translatorErrors;
+    result->error = task->error;
+    if (task->isValid())
+      result->translated = diffs_[it->second.area].apply(task->translated);
+    parts_.erase(it);
+  }
+
+  manager_.translated(result);
   queue_.erase(std::remove(queue_.begin(), queue_.end(), task), queue_.end());
 }
 
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "stfwd.h"
+#include "translationdiff.h"
 
 #include <QWidget>
 
+class QWebEngineProfile;
 class QWebEngineView;
 class QTabWidget;
 class QLineEdit;
@@ -20,6 +22,8 @@ public:
   void translate(const TaskPtr &task);
   void updateSettings();
   void finish(const TaskPtr &task);
+  qint64 memoryUsage() const;
+  void releaseMemory();
 
   static QStringList availableTranslators(const QString &path);
   static QStringList availableLanguageNames();
@@ -28,13 +32,24 @@ protected:
   void timerEvent(QTimerEvent *event) override;
 
 private:
+  struct Part {
+    TaskPtr whole;
+    QString area;
+  };
+  struct Profile {
+    QString path;  // empty for off-the-record one
+    std::unique_ptr<QWebEngineProfile> profile;
+  };
+
   WebPage *currentPage() const;
   void udpateCurrentPage();
   void updateUrl();
   void setPageLoadImages(bool isOn);
   void processQueue();
   void markTranslated(const TaskPtr &task);
+  void translateChanged(const TaskPtr &task);
   void createPage(const QString &scriptName, const QString &scriptText);
+  QWebEngineProfile *profile(const QString &scriptName);
   void showDebugView();
 
   Manager &manager_;
@@ -46,6 +61,9 @@ private:
   QAction *showDebugAction_;
   QTabWidget *tabs_;
   std::vector<TaskPtr> queue_;
+  std::map<QString, Profile> profiles_;  // outlive pages
   std::map<QString, std::unique_ptr<WebPage>> pages_;
+  std::map<QString, TranslationDiff> diffs_;
+  std::map<TaskPtr, Part> parts_;  // changed lines of watched areas
   quint16 debugPort_{0};
 };
@@ -11,13 +11,13 @@
 #include <QtWebChannel>
 
 WebPage::WebPage(Translator &translator, const QString &script,
-                 const QString &scriptName)
-  : QWebEnginePage(new QWebEngineProfile)
+                 const QString &scriptName, QWebEngineProfile *profile)
+  : QWebEnginePage(profile)
   , translator_(translator)
   , scriptName_(scriptName)
   , proxy_(new WebPageProxy(*this))
 {
-  profile()->setParent(this);
+  this->profile()->scripts()->clear();  // of the previous page
 
   changeUserAgent();
 
@@ -11,8 +11,9 @@ class WebPage : public QWebEnginePage
 {
   Q_OBJECT
 public:
+  // Profile must outlive the page, its scripts are replaced.
   WebPage(Translator &translator, const QString &script,
-          const QString &scriptName);
+          const QString &scriptName, QWebEngineProfile *profile);
   ~WebPage();
 
   void setIgnoreSslErrors(bool ignoreSslErrors);
@@ -1,6 +1,7 @@
 #include "trayicon.h"
 #include "debug.h"
 #include "globalaction.h"
+#include "latencymonitor.h"
 #include "manager.h"
 #include "settings.h"
 
@@ -34,19 +35,14 @@ TrayIcon::~TrayIcon() = default;
 
 void TrayIcon::updateSettings()
 {
-  QStringList failedActions;
-  if (!GlobalAction::update(captureAction_, settings_.captureHotkey))
-    failedActions << settings_.captureHotkey;
-  if (!GlobalAction::update(repeatCaptureAction_,
-                            settings_.repeatCaptureHotkey))
-    failedActions << settings_.repeatCaptureHotkey;
-  if (!GlobalAction::update(showLastAction_, settings_.showLastHotkey))
-    failedActions << settings_.showLastHotkey;
-  if (!GlobalAction::update(clipboardAction_, settings_.clipboardHotkey))
-    failedActions << settings_.clipboardHotkey;
-  if (!GlobalAction::update(captureLockedAction_,
-                            settings_.captureLockedHotkey))
-    failedActions << settings_.captureLockedHotkey;
+  const auto failedActions = GlobalAction::update({
+      {captureAction_, settings_.captureHotkey},
+      {repeatCaptureAction_, settings_.repeatCaptureHotkey},
+      {showLastAction_, settings_.showLastHotkey},
+      {clipboardAction_, settings_.clipboardHotkey},
+      {captureLockedAction_, settings_.captureLockedHotkey},
+      {translateSelectionAction_, settings_.translateSelectionHotkey},
+  });
 
   if (!failedActions.isEmpty()) {
     showError(tr("Failed to register global shortcuts:\n%1"
@@ -70,6 +66,8 @@ void TrayIcon::setTaskActionsEnabled(bool isEnabled)
 void TrayIcon::setCaptureLockedEnabled(bool isEnabled)
 {
   canCaptureLocked_ = isEnabled;
+  if (!isEnabled)
+    watchLockedAction_->setChecked(false);
   updateActions();
 }
 
@@ -84,19 +82,23 @@ void TrayIcon::updateActions()
   if (isActionsBlocked_) {
     QVector<QAction *> blockable{captureAction_, repeatCaptureAction_,
                                  showLastAction_, settingsAction_,
-                                 captureLockedAction_};
+                                 captureLockedAction_, watchLockedAction_,
+                                 translateSelectionAction_, openImagesAction_};
     for (auto &action : blockable) action->setEnabled(false);
     return;
   }
 
   captureAction_->setEnabled(true);
   settingsAction_->setEnabled(true);
+  translateSelectionAction_->setEnabled(true);
+  openImagesAction_->setEnabled(true);
 
   QVector<QAction *> taskActions{showLastAction_, clipboardAction_};
   for (auto &action : taskActions) action->setEnabled(gotTask_);
 
   repeatCaptureAction_->setEnabled(canRepeatCapture_);
   captureLockedAction_->setEnabled(canCaptureLocked_);
+  watchLockedAction_->setEnabled(canCaptureLocked_);
 }
 
 void TrayIcon::setIcon(TrayIcon::Icon icon, Duration duration)
@@ -169,6 +171,59 @@ void TrayIcon::showSuccess()
   setIcon(Icon::Success, Duration::Temporal);
 }
 
+void TrayIcon::updateLatency(const service::LatencyMonitor &monitor)
+{
+  using Monitor = service::LatencyMonitor;
+  SOFT_ASSERT(latencyMenu_, return );
+
+  latencyMenu_->clear();
+  if (monitor.sampleCount() == 0) {
+    latencyMenu_->setTitle(tr("Latency: no data"));
+    latencyMenu_->setIcon({});
+    tray_->setToolTip({});
+    return;
+  }
+
+  const auto format = [](const Monitor::Percentiles &percentiles) {
+    return tr("p50 %1 ms, p95 %2 ms")
+        .arg(percentiles.p50)
+        .arg(percentiles.p95);
+  };
+
+  const auto total = monitor.total();
+  const auto budget = settings_.latencyBudget.count();
+  const auto isSlow = total.p95 > budget;
+  latencyMenu_->setTitle(tr("Latency: %1").arg(format(total)));
+  latencyMenu_->setIcon(isSlow ? QIcon(QStringLiteral(":icons/st_error.png"))
+                               : QIcon());
+
+  QStringList toolTip{tr("Latency: %1").arg(format(total))};
+  const auto slowest = monitor.slowestStage();
+  for (auto i = 0; i < Monitor::stageCount; ++i) {
+    const auto stage = Monitor::Stage(i);
+    const auto text =
+        Monitor::stageName(stage) + QLatin1String(": ") +
+        format(monitor.stage(stage));
+    auto action = latencyMenu_->addAction(text);
+    if (stage != slowest) {
+      toolTip.append(text);
+      continue;
+    }
+    auto font = action->font();
+    font.setBold(true);
+    action->setFont(font);
+    toolTip.append(QLatin1String("> ") + text);
+  }
+
+  latencyMenu_->addSeparator();
+  latencyMenu_->addAction(tr("Target: p95 under %1 ms, last %2 captures")
+                              .arg(budget)
+                              .arg(monitor.sampleCount()));
+  if (isSlow)
+    toolTip.append(tr("Target of %1 ms is exceeded").arg(budget));
+  tray_->setToolTip(toolTip.join('\n'));
+}
+
 void TrayIcon::handleIconClick(QSystemTrayIcon::ActivationReason reason)
 {
   if (reason == QSystemTrayIcon::Trigger && showLastAction_->isEnabled()) {
@@ -205,6 +260,22 @@ QMenu *TrayIcon::contextMenu()
     connect(captureLockedAction_, &QAction::triggered,  //
             this, [this] { manager_.captureLocked(); });
   }
+  {
+    watchLockedAction_ = menu->addAction(tr("Watch saved areas"));
+    watchLockedAction_->setCheckable(true);
+    connect(watchLockedAction_, &QAction::toggled,  //
+            this, [this](bool isOn) { manager_.setWatching(isOn); });
+  }
+  {
+    translateSelectionAction_ = menu->addAction(tr("Translate selection"));
+    connect(translateSelectionAction_, &QAction::triggered,  //
+            this, [this] { manager_.translateSelection(); });
+  }
+  {
+    openImagesAction_ = menu->addAction(tr("Recognize images..."));
+    connect(openImagesAction_, &QAction::triggered,  //
+            this, [this] { manager_.openImages(); });
+  }
 
   {
     QMenu *translateMenu = menu->addMenu(tr("Result"));
@@ -220,12 +291,22 @@ QMenu *TrayIcon::contextMenu()
     }
   }
 
+  {
+    latencyMenu_ = menu->addMenu(tr("Latency: no data"));
+  }
+
   {
     auto action = menu->addAction(tr("Show translator"));
     connect(action, &QAction::triggered,  //
             this, [this] { manager_.showTranslator(); });
   }
 
+  {
+    auto action = menu->addAction(tr("Diagnostics"));
+    connect(action, &QAction::triggered,  //
+            this, [this] { manager_.showDiagnostics(); });
+  }
+
   {
     settingsAction_ = menu->addAction(tr("Settings"));
     connect(settingsAction_, &QAction::triggered,  //
@@ -6,6 +6,11 @@
 
 class QAction;
 
+namespace service
+{
+class LatencyMonitor;
+}
+
 class TrayIcon : public QObject
 {
   Q_OBJECT
@@ -26,6 +31,7 @@ public:
   void showError(const QString &text);
   void showFatalError(const QString &text);
   void showSuccess();
+  void updateLatency(const service::LatencyMonitor &monitor);
 
 private:
   enum class Icon { Idle, Success, Busy, Error };
@@ -42,10 +48,14 @@ private:
 
   QAction *captureAction_{nullptr};
   QAction *captureLockedAction_{nullptr};
+  QAction *watchLockedAction_{nullptr};
+  QAction *translateSelectionAction_{nullptr};
+  QAction *openImagesAction_{nullptr};
   QAction *repeatCaptureAction_{nullptr};
   QAction *showLastAction_{nullptr};
   QAction *clipboardAction_{nullptr};
   QAction *settingsAction_{nullptr};
+  QMenu *latencyMenu_{nullptr};
 
   std::unique_ptr<QTimer> iconUpdateTimer_;
   int activeTaskCount_{0};
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "changedetector.h"
+
+#include <QImage>
+#include <QPainter>
+
+namespace
+{
+QImage frame()
+{
+  QImage image(320, 160, QImage::Format_RGB32);
+  image.fill(Qt::white);
+  return image;
+}
+
+void draw(QImage &image, const QRect &rect, const QColor &color)
+{
+  QPainter painter(&image);
+  painter.fillRect(rect, color);
+}
+}  // namespace
+
+TEST(ChangeDetector, Signature)
+{
+  auto image = frame();
+  draw(image, {0, 0, 160, 160}, Qt::black);
+  const auto signature = ChangeDetector::signature(image);
+  ASSERT_EQ(size_t(ChangeDetector::gridSize * ChangeDetector::gridSize),
+            signature.size());
+  EXPECT_EQ(0, signature.front());
+  EXPECT_EQ(255, signature.back());
+}
+
+TEST(ChangeDetector, FirstFrameChanged)
+{
+  ChangeDetector testee;
+  EXPECT_TRUE(testee.isChanged(frame()));
+  EXPECT_FALSE(testee.isChanged(frame()));
+}
+
+TEST(ChangeDetector, IgnoreNoise)
+{
+  ChangeDetector testee;
+  testee.isChanged(frame());
+  auto image = frame();
+  image.setPixel(5, 5, qRgb(128, 128, 128));
+  EXPECT_FALSE(testee.isChanged(image));
+}
+
+TEST(ChangeDetector, DetectText)
+{
+  ChangeDetector testee;
+  testee.isChanged(frame());
+  auto image = frame();
+  draw(image, {20, 20, 100, 12}, Qt::black);
+  EXPECT_TRUE(testee.isChanged(image));
+  EXPECT_FALSE(testee.isChanged(image));
+}
+
+TEST(ChangeDetector, LearnAnimation)
+{
+  ChangeDetector testee;
+  testee.isChanged(frame());
+
+  const QRect spinner(300, 140, 20, 20);
+  auto changes = 0;
+  for (auto i = 0; i < 10; ++i) {
+    auto image = frame();
+    draw(image, spinner, i % 2 ? Qt::black : Qt::blue);
+    changes += testee.isChanged(image);
+  }
+  EXPECT_LT(changes, 10);
+
+  auto image = frame();
+  draw(image, spinner, Qt::red);
+  EXPECT_FALSE(testee.isChanged(image));
+
+  draw(image, {20, 20, 100, 12}, Qt::black);
+  EXPECT_TRUE(testee.isChanged(image));
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "confusionmatrix.h"
+
+TEST(ConfusionMatrix, PlainEdits)
+{
+  ConfusionMatrix testee;
+  EXPECT_DOUBLE_EQ(0.0, testee.distance("word", "word"));
+  EXPECT_DOUBLE_EQ(4.0, testee.distance("", "word"));
+  EXPECT_DOUBLE_EQ(4.0, testee.distance("word", ""));
+  EXPECT_DOUBLE_EQ(1.0, testee.distance("word", "ward"));
+  EXPECT_DOUBLE_EQ(1.0, testee.distance("word", "words"));
+  EXPECT_DOUBLE_EQ(3.0, testee.distance("kitten", "sitting"));
+}
+
+TEST(ConfusionMatrix, BuiltinConfusions)
+{
+  ConfusionMatrix testee;
+  const auto merged = testee.distance("rnodern", "modern");
+  EXPECT_LT(merged, 1.0);
+  EXPECT_LT(testee.distance("c1ear", "clear"), 1.0);
+  EXPECT_LT(testee.distance("H0ME", "HOME"), 1.0);
+  EXPECT_DOUBLE_EQ(1.0, testee.distance("xodern", "modern"));
+}
+
+TEST(ConfusionMatrix, RanksOcrConfusionsFirst)
+{
+  ConfusionMatrix testee;
+  EXPECT_LT(testee.distance("barn", "bam"), testee.distance("barn", "bar"));
+}
+
+TEST(ConfusionMatrix, Learn)
+{
+  ConfusionMatrix testee;
+  const auto before = testee.distance("qerson", "person");
+  testee.learn("the qerson here", "the person here");
+  const auto learned = testee.distance("qerson", "person");
+  EXPECT_LT(learned, before);
+
+  testee.learn("qlace", "place");
+  EXPECT_LT(testee.distance("qerson", "person"), learned);
+}
+
+TEST(ConfusionMatrix, LearnIgnoresLongChanges)
+{
+  ConfusionMatrix testee;
+  testee.learn("abcdef", "uvwxyz");
+  EXPECT_DOUBLE_EQ(6.0, testee.distance("abcdef", "uvwxyz"));
+}
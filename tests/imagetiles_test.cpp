@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "imagetiles.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QTransform>
+
+namespace
+{
+// text-like lines every 30 rows
+QImage page(int height)
+{
+  QImage image(300, height, QImage::Format_RGB32);
+  image.fill(Qt::white);
+  QPainter painter(&image);
+  for (auto y = 10; y + 12 < height; y += 30)
+    painter.fillRect(10, y, 200, 12, Qt::black);
+  return image;
+}
+
+void checkTiles(ImageTiles &tiles, int height)
+{
+  auto total = 0;
+  auto count = 0;
+  while (!tiles.atEnd()) {
+    const auto tile = tiles.next();
+    ASSERT_FALSE(tile.isNull());
+    EXPECT_LE(tile.height(), ImageTiles::tileHeight + 200);
+    // cut at empty row, so no line is split
+    const auto last = tile.height() - 1;
+    EXPECT_EQ(qRgb(255, 255, 255), tile.pixel(50, last) | 0xff000000);
+    total += tile.height();
+    ++count;
+  }
+  EXPECT_TRUE(tiles.error().isEmpty());
+  EXPECT_EQ(height, total);
+  EXPECT_GT(count, 1);
+}
+}  // namespace
+
+TEST(ImageTiles, Small)
+{
+  ImageTiles tiles(page(500));
+  EXPECT_FALSE(ImageTiles::isLarge(tiles.size()));
+  EXPECT_EQ(500, tiles.next().height());
+  EXPECT_TRUE(tiles.atEnd());
+}
+
+TEST(ImageTiles, Large)
+{
+  const auto height = 7000;
+  ImageTiles tiles(page(height));
+  EXPECT_TRUE(ImageTiles::isLarge(tiles.size()));
+  checkTiles(tiles, height);
+}
+
+TEST(ImageTiles, File)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const auto height = 5000;
+  const auto fileName = dir.filePath("page.png");
+  ASSERT_TRUE(page(height).save(fileName));
+
+  ImageTiles tiles(fileName);
+  EXPECT_EQ(QSize(300, height), tiles.size());
+  checkTiles(tiles, height);
+}
+
+TEST(ImageTiles, Rotated)
+{
+  // text lines go from bottom to top, as after osd rotation of 90
+  const auto height = 7000;
+  const auto source = page(height).transformed(QTransform().rotate(-90));
+  ImageTiles tiles(source, 90);
+  EXPECT_EQ(source.size(), tiles.sourceSize());
+  EXPECT_EQ(QSize(300, height), tiles.size());
+
+  const auto line = QRect(10, 3990, 200, 12);  // in upright image
+  const auto mapped = tiles.toSource(line);
+  EXPECT_EQ(QSize(12, 200), mapped.size());
+  EXPECT_EQ(qRgb(0, 0, 0), source.pixel(mapped.center()) | 0xff000000);
+  EXPECT_TRUE(QRect(QPoint(), source.size()).contains(mapped));
+
+  checkTiles(tiles, height);
+}
+
+TEST(ImageTiles, MissingFile)
+{
+  ImageTiles tiles(QStringLiteral("missing.png"));
+  EXPECT_FALSE(tiles.error().isEmpty());
+  EXPECT_TRUE(tiles.atEnd());
+}
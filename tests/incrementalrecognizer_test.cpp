@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "incrementalrecognizer.h"
+
+#include <QImage>
+#include <QPainter>
+
+namespace
+{
+const auto lineHeight = 10;
+const auto lineSpacing = 6;
+
+// every line is drawn as unique pattern of black blocks
+QImage render(const std::vector<int> &lines, int scroll = 0)
+{
+  QImage image(200, 120, QImage::Format_RGB32);
+  image.fill(Qt::white);
+  QPainter painter(&image);
+  auto top = lineSpacing - scroll;
+  for (const auto line : lines) {
+    for (auto bit = 0; bit < 8; ++bit) {
+      if (line & (1 << bit))
+        painter.fillRect(10 + bit * 20, top, 12, lineHeight, Qt::black);
+    }
+    top += lineHeight + lineSpacing;
+  }
+  return image;
+}
+
+struct Counter {
+  int calls{0};
+  IncrementalRecognizer::RecognizeLine recognize()
+  {
+    return [this](const QImage &) { return QString::number(++calls); };
+  }
+};
+}  // namespace
+
+TEST(IncrementalRecognizer, Segment)
+{
+  const auto lines = IncrementalRecognizer::segment(render({1, 3, 7}));
+  ASSERT_EQ(3, int(lines.size()));
+  EXPECT_EQ(lineSpacing, lines[0].top);
+  EXPECT_EQ(lineSpacing + lineHeight, lines[0].bottom);
+  EXPECT_NE(lines[0].hash, lines[1].hash);
+}
+
+TEST(IncrementalRecognizer, SegmentEmpty)
+{
+  EXPECT_TRUE(IncrementalRecognizer::segment(render({})).empty());
+  EXPECT_TRUE(IncrementalRecognizer::segment(QImage()).empty());
+}
+
+TEST(IncrementalRecognizer, ReuseUnchanged)
+{
+  IncrementalRecognizer testee;
+  Counter counter;
+  EXPECT_EQ("1\n2", testee.recognize(render({1, 3}), counter.recognize()));
+  EXPECT_EQ("1\n2", testee.recognize(render({1, 3}), counter.recognize()));
+  EXPECT_EQ(2, counter.calls);
+  EXPECT_EQ(2, testee.reusedLines());
+}
+
+TEST(IncrementalRecognizer, RecognizeChangedOnly)
+{
+  IncrementalRecognizer testee;
+  Counter counter;
+  testee.recognize(render({1, 3}), counter.recognize());
+  EXPECT_EQ("1\n3", testee.recognize(render({1, 5}), counter.recognize()));
+  EXPECT_EQ(3, counter.calls);
+  EXPECT_EQ(1, testee.reusedLines());
+}
+
+TEST(IncrementalRecognizer, Scroll)
+{
+  IncrementalRecognizer testee;
+  Counter counter;
+  testee.recognize(render({1, 3, 7}), counter.recognize());
+
+  const auto shift = lineHeight + lineSpacing;
+  const auto scrolled = render({1, 3, 7, 15}, shift);
+  EXPECT_EQ("2\n3\n4", testee.recognize(scrolled, counter.recognize()));
+  EXPECT_EQ(4, counter.calls);
+  EXPECT_EQ(2, testee.reusedLines());
+  EXPECT_EQ(-shift, testee.scrollOffset());
+}
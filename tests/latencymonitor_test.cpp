@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "latencymonitor.h"
+
+using LatencyMonitor = service::LatencyMonitor;
+using LatencyMarks = service::LatencyMarks;
+
+namespace
+{
+// requested at 1000, stages take given times
+LatencyMarks marks(qint64 capture, qint64 recognition, qint64 correction,
+                   qint64 translation, qint64 display)
+{
+  LatencyMarks result{};
+  result[0] = 1000;
+  const qint64 durations[] = {capture, recognition, correction, translation,
+                              display};
+  for (auto i = 0; i < LatencyMonitor::stageCount; ++i)
+    result[i + 1] = result[i] + durations[i];
+  return result;
+}
+}  // namespace
+
+TEST(LatencyMonitor, Empty)
+{
+  LatencyMonitor monitor;
+  EXPECT_EQ(0, monitor.sampleCount());
+  EXPECT_EQ(0, monitor.total().p95);
+}
+
+TEST(LatencyMonitor, Percentiles)
+{
+  LatencyMonitor monitor;
+  for (auto i = 1; i <= 100; ++i) monitor.add(marks(0, i, 0, 0, 0));
+
+  EXPECT_EQ(50, monitor.stage(LatencyMonitor::Recognition).p50);
+  EXPECT_EQ(95, monitor.stage(LatencyMonitor::Recognition).p95);
+  EXPECT_EQ(95, monitor.total().p95);
+  EXPECT_EQ(LatencyMonitor::Recognition, monitor.slowestStage());
+}
+
+TEST(LatencyMonitor, SkippedStage)
+{
+  LatencyMonitor monitor;
+  auto skipped = marks(10, 0, 5, 200, 20);
+  skipped[size_t(service::LatencyMark::Recognized)] = 0;
+  monitor.add(skipped);
+
+  EXPECT_EQ(0, monitor.stage(LatencyMonitor::Recognition).p50);
+  EXPECT_EQ(5, monitor.stage(LatencyMonitor::Correction).p50);
+  EXPECT_EQ(235, monitor.total().p50);
+  EXPECT_EQ(LatencyMonitor::Translation, monitor.slowestStage());
+}
+
+TEST(LatencyMonitor, Window)
+{
+  LatencyMonitor monitor(10);
+  for (auto i = 0; i < 10; ++i) monitor.add(marks(0, 1000, 0, 0, 0));
+  for (auto i = 0; i < 10; ++i) monitor.add(marks(0, 10, 0, 0, 0));
+
+  EXPECT_EQ(10, monitor.sampleCount());
+  EXPECT_EQ(10, monitor.total().p95);
+}
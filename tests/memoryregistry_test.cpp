@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "memoryregistry.h"
+
+using MemoryRegistry = service::MemoryRegistry;
+
+TEST(MemoryRegistry, Measure)
+{
+  MemoryRegistry registry;
+  registry.add("first", [] { return qint64(100); });
+  registry.add("second", [] { return qint64(200); });
+  EXPECT_EQ(0, registry.total());
+
+  registry.update();
+  EXPECT_EQ(300, registry.total());
+  ASSERT_EQ(2, int(registry.usages().size()));
+  EXPECT_EQ("second", registry.usages()[1].name);
+  EXPECT_TRUE(registry.report().contains("first: 100 B"));
+}
+
+TEST(MemoryRegistry, ReleaseOverLimit)
+{
+  MemoryRegistry registry;
+  qint64 cache = 5000;
+  registry.add(
+      "cache", [&cache] { return cache; }, 1000, [&cache] { cache = 10; });
+  auto releasedOther = false;
+  registry.add(
+      "other", [] { return qint64(500); }, 1000,
+      [&releasedOther] { releasedOther = true; });
+
+  registry.update();
+  EXPECT_EQ(10, cache);
+  EXPECT_FALSE(releasedOther);
+
+  const auto usages = registry.usages();
+  EXPECT_EQ(10, usages[0].bytes);
+  EXPECT_EQ(1, usages[0].releaseCount);
+  EXPECT_EQ(0, usages[1].releaseCount);
+}
+
+TEST(MemoryRegistry, SizeString)
+{
+  EXPECT_EQ("512 B", MemoryRegistry::sizeString(512));
+  EXPECT_EQ("1.5 KB", MemoryRegistry::sizeString(1536));
+  EXPECT_EQ("3.0 MB", MemoryRegistry::sizeString(3 * 1024 * 1024));
+}
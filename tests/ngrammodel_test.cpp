@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "ngramcorrector.h"
+#include "ngrammodel.h"
+
+#include <QTemporaryDir>
+
+#include <algorithm>
+
+namespace
+{
+quint64 hash(const QString& ngram)
+{
+  quint64 result = 14695981039346656037ull;
+  for (const auto byte : ngram.toLower().toUtf8()) {
+    result ^= quint8(byte);
+    result *= 1099511628211ull;
+  }
+  return result;
+}
+
+// bigram model, code i means log10 probability -i/2
+QByteArray model(std::vector<std::pair<QString, quint8>> ngrams)
+{
+  std::sort(ngrams.begin(), ngrams.end(), [](const auto& l, const auto& r) {
+    return hash(l.first) < hash(r.first);
+  });
+
+  QByteArray result("STLM", 4);
+  const auto append = [&result](const auto& value) {
+    result.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  append(quint32(1));
+  append(quint32(2));
+  append(quint32(ngrams.size()));
+  append(-5.0f);  // unknown
+  append(-0.4f);  // backoff
+  for (auto i = 0; i < 256; ++i) append(float(-0.5 * i));
+  for (const auto& ngram : ngrams) append(hash(ngram.first));
+  for (const auto& ngram : ngrams) append(ngram.second);
+  return result;
+}
+
+QByteArray sample()
+{
+  return model({{"the", 2}, {"cat", 4}, {"the cat", 1}});
+}
+
+QString save(const QTemporaryDir& dir, const QString& name,
+             const QByteArray& data)
+{
+  const auto fileName = dir.filePath(name);
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly) || file.write(data) != data.size())
+    return {};
+  return fileName;
+}
+}  // namespace
+
+TEST(NgramModel, StupidBackoff)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QString error;
+  const auto testee = NgramModel::load(save(dir, "en.stlm", sample()), error);
+  ASSERT_TRUE(testee) << error.toStdString();
+  EXPECT_EQ(2, testee->order());
+
+  EXPECT_NEAR(-0.5, testee->score({"the"}, "cat"), 1e-5);
+  EXPECT_NEAR(-0.5, testee->score({"a", "The"}, "Cat"), 1e-5);
+  EXPECT_NEAR(-2.4, testee->score({"a"}, "cat"), 1e-5);
+  EXPECT_NEAR(-1.0, testee->score({}, "the"), 1e-5);
+  EXPECT_NEAR(-5.4, testee->score({}, "dog"), 1e-5);
+}
+
+TEST(NgramModel, SharedByFile)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const auto fileName = save(dir, "en.stlm", sample());
+  QString error;
+  const auto first = NgramModel::load(fileName, error);
+  const auto second = NgramModel::load(fileName, error);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first, second);
+}
+
+TEST(NgramModel, RejectsCorrupted)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  QString error;
+  EXPECT_FALSE(NgramModel::load(dir.filePath("missing.stlm"), error));
+  EXPECT_FALSE(error.isEmpty());
+
+  error.clear();
+  EXPECT_FALSE(NgramModel::load(save(dir, "small.stlm", "STLM"), error));
+  EXPECT_FALSE(error.isEmpty());
+
+  auto magic = sample();
+  magic[0] = 'X';
+  error.clear();
+  EXPECT_FALSE(NgramModel::load(save(dir, "magic.stlm", magic), error));
+  EXPECT_FALSE(error.isEmpty());
+
+  const auto truncated = sample().chopped(1);
+  error.clear();
+  EXPECT_FALSE(NgramModel::load(save(dir, "cut.stlm", truncated), error));
+  EXPECT_FALSE(error.isEmpty());
+}
+
+TEST(NgramCorrector, ChoosesBestAlternatives)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  ASSERT_FALSE(save(dir, "en.stlm", sample()).isEmpty());
+  NgramCorrector testee("eng", dir.path());
+  ASSERT_TRUE(testee.isValid()) << testee.error().toStdString();
+
+  const WordAlternatives alternatives{{"tho", {"the"}}, {"cot", {"cat"}}};
+  EXPECT_EQ("the cat.\nthe cat", testee.correct("tho cot.\nthe cot",
+                                                alternatives));
+  EXPECT_EQ("dog", testee.correct("dog", alternatives));
+  EXPECT_EQ("tho cot", testee.correct("tho cot", {}));
+}
+
+TEST(NgramCorrector, PrefersRecognizedOnTies)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  ASSERT_FALSE(save(dir, "en.stlm", sample()).isEmpty());
+  NgramCorrector testee("eng", dir.path());
+  ASSERT_TRUE(testee.isValid());
+
+  // both are unknown, so only the bonus of recognized one differs
+  EXPECT_EQ("the dog", testee.correct("the dog", {{"dog", {"dot"}}}));
+  EXPECT_EQ("the cat", testee.correct("the cat", {{"cat", {"cot"}}}));
+}
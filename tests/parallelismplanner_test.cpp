@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "parallelismplanner.h"
+
+namespace
+{
+const auto small = ParallelismPlanner::smallImagePixels / 2;
+const auto large = ParallelismPlanner::smallImagePixels * 10;
+}  // namespace
+
+TEST(ParallelismPlanner, Image)
+{
+  ParallelismPlanner testee(OcrParallelism::Image, 8, 4);
+  const auto plan = testee.plan(large, 5);
+  EXPECT_EQ(1, plan.workers);
+  EXPECT_EQ(8, plan.threadsPerEngine);
+}
+
+TEST(ParallelismPlanner, Task)
+{
+  ParallelismPlanner testee(OcrParallelism::Task, 8, 4);
+  auto plan = testee.plan(large, 2);
+  EXPECT_EQ(2, plan.workers);
+  EXPECT_EQ(1, plan.threadsPerEngine);
+
+  plan = testee.plan(large, 10);
+  EXPECT_EQ(4, plan.workers);
+}
+
+TEST(ParallelismPlanner, AutoSingleImage)
+{
+  ParallelismPlanner testee(OcrParallelism::Auto, 8, 4);
+  auto plan = testee.plan(large, 1);
+  EXPECT_EQ(1, plan.workers);
+  EXPECT_EQ(8, plan.threadsPerEngine);
+
+  plan = testee.plan(small, 1);
+  EXPECT_EQ(1, plan.workers);
+  EXPECT_EQ(1, plan.threadsPerEngine);
+}
+
+TEST(ParallelismPlanner, AutoQueue)
+{
+  ParallelismPlanner testee(OcrParallelism::Auto, 8, 4);
+  auto plan = testee.plan(large, 2);
+  EXPECT_EQ(2, plan.workers);
+  EXPECT_EQ(4, plan.threadsPerEngine);
+
+  plan = testee.plan(small, 6);
+  EXPECT_EQ(4, plan.workers);
+  EXPECT_EQ(1, plan.threadsPerEngine);
+}
+
+TEST(ParallelismPlanner, BudgetLimitsWorkers)
+{
+  ParallelismPlanner testee(OcrParallelism::Auto, 2, 4);
+  const auto plan = testee.plan(large, 6);
+  EXPECT_EQ(2, plan.workers);
+  EXPECT_EQ(1, plan.threadsPerEngine);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "pipeline.h"
+#include "task.h"
+
+namespace
+{
+// records stage names, stages report synchronously unless deferred
+struct Recorder {
+  Pipeline pipeline;
+  QStringList calls;
+  std::vector<TaskPtr> deferred;
+  std::vector<TaskPtr> finished;
+
+  Pipeline::Handler stage(const QString &name, bool defer = false)
+  {
+    return [this, name, defer](const TaskPtr &task) {
+      calls.append(name);
+      if (defer)
+        deferred.push_back(task);
+      else
+        pipeline.advance(task);
+    };
+  }
+
+  Recorder()
+  {
+    pipeline.finally([this](const TaskPtr &task) {
+      calls.append("finish");
+      finished.push_back(task);
+    });
+  }
+};
+}  // namespace
+
+TEST(Pipeline, RunsStagesInOrder)
+{
+  Recorder r;
+  r.pipeline.then({"a", r.stage("a")}).then({"b", r.stage("b")});
+  r.pipeline.start(std::make_shared<Task>());
+  EXPECT_EQ(QStringList({"a", "b", "finish"}), r.calls);
+  EXPECT_EQ(-1, r.finished.front()->pipelineStage);
+}
+
+TEST(Pipeline, SkipsNotNeeded)
+{
+  Recorder r;
+  r.pipeline.then({"a", r.stage("a"), [](const TaskPtr &) { return false; }})
+      .then({"b", r.stage("b")});
+  r.pipeline.start(std::make_shared<Task>());
+  EXPECT_EQ(QStringList({"b", "finish"}), r.calls);
+}
+
+TEST(Pipeline, ErrorStopsTask)
+{
+  Recorder r;
+  r.pipeline
+      .then({"a",
+             [&r](const TaskPtr &task) {
+               task->error = "failed";
+               r.pipeline.advance(task);
+             }})
+      .then({"b", r.stage("b")});
+  r.pipeline.start(std::make_shared<Task>());
+  EXPECT_EQ(QStringList({"finish"}), r.calls);
+
+  r.calls.clear();
+  auto invalid = std::make_shared<Task>();
+  invalid->error = "failed";
+  r.pipeline.start(invalid);
+  EXPECT_EQ(QStringList({"finish"}), r.calls);
+}
+
+TEST(Pipeline, OptionalStageError)
+{
+  Recorder r;
+  r.pipeline
+      .then({"a",
+             [&r](const TaskPtr &task) {
+               task->error = "failed";
+               r.pipeline.advance(task);
+             },
+             {},
+             true})
+      .then({"b", r.stage("b")})
+      .then({"c", r.stage("c")});
+  r.pipeline.start(std::make_shared<Task>());
+  EXPECT_EQ(QStringList({"b", "finish"}), r.calls);
+}
+
+TEST(Pipeline, OutOfOrderCompletion)
+{
+  Recorder r;
+  r.pipeline.then({"a", r.stage("a", true)}).then({"b", r.stage("b")});
+
+  const auto first = std::make_shared<Task>();
+  const auto second = std::make_shared<Task>();
+  r.pipeline.start(first);
+  r.pipeline.start(second);
+  EXPECT_EQ("a", r.pipeline.stageName(first));
+
+  r.pipeline.advance(second);
+  r.pipeline.advance(first);
+  ASSERT_EQ(2, int(r.finished.size()));
+  EXPECT_EQ(second, r.finished[0]);
+  EXPECT_EQ(first, r.finished[1]);
+}
+
+TEST(Pipeline, StartAtNamedStage)
+{
+  Recorder r;
+  r.pipeline.then({"a", r.stage("a")})
+      .then({"b", r.stage("b")})
+      .then({"c", r.stage("c")});
+
+  const auto task = std::make_shared<Task>();
+  r.pipeline.start(task);
+  ASSERT_EQ(-1, task->pipelineStage);
+
+  r.calls.clear();
+  r.pipeline.startAt(task, "b");
+  EXPECT_EQ(QStringList({"b", "c", "finish"}), r.calls);
+  EXPECT_EQ(-1, task->pipelineStage);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "pixpool.h"
+
+namespace
+{
+const auto large = size_t(4 * 1024 * 1024);
+}
+
+TEST(PixPool, ReuseFreed)
+{
+  PixPool pool;
+  auto first = pool.allocate(large);
+  ASSERT_NE(nullptr, first);
+  pool.deallocate(first);
+
+  auto second = pool.allocate(large - 1000);
+  EXPECT_EQ(first, second);
+  pool.deallocate(second);
+
+  const auto stats = pool.stats();
+  EXPECT_EQ(2, stats.allocations);
+  EXPECT_EQ(1, stats.reused);
+  EXPECT_EQ(0, stats.usedBytes);
+  EXPECT_LE(qint64(large), stats.pooledBytes);
+}
+
+TEST(PixPool, NoReuseOfMuchLarger)
+{
+  PixPool pool;
+  auto big = pool.allocate(large);
+  pool.deallocate(big);
+
+  auto small = pool.allocate(large / 2);
+  pool.deallocate(small);
+  EXPECT_EQ(0, pool.stats().reused);
+}
+
+TEST(PixPool, SmallAreNotPooled)
+{
+  PixPool pool;
+  auto small = pool.allocate(100);
+  ASSERT_NE(nullptr, small);
+  pool.deallocate(small);
+  EXPECT_EQ(0, pool.stats().allocations);
+  EXPECT_EQ(0, pool.stats().pooledBytes);
+}
+
+TEST(PixPool, LimitAndClear)
+{
+  PixPool pool(qint64(large + large / 2));
+  auto first = pool.allocate(large);
+  auto second = pool.allocate(large);
+  pool.deallocate(first);
+  pool.deallocate(second);  // over the limit, freed
+  EXPECT_GE(qint64(large + large / 2), pool.stats().pooledBytes);
+
+  pool.clear();
+  EXPECT_EQ(0, pool.stats().pooledBytes);
+  EXPECT_LE(qint64(2 * large), pool.stats().peakBytes);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "substitutiondfa.h"
+
+namespace
+{
+Substitution text(const QString& source, const QString& target)
+{
+  return {source, target, SubstitutionType::Text};
+}
+Substitution word(const QString& source, const QString& target)
+{
+  return {source, target, SubstitutionType::Word};
+}
+Substitution regex(const QString& source, const QString& target)
+{
+  return {source, target, SubstitutionType::Regex};
+}
+}  // namespace
+
+TEST(SubstitutionDfa, Text)
+{
+  SubstitutionDfa testee({text("rn", "m"), text("c1", "cl")});
+  EXPECT_TRUE(testee.errors().isEmpty());
+  EXPECT_EQ("modem", testee.apply("rnodern"));
+  EXPECT_EQ("clear", testee.apply("c1ear"));
+  EXPECT_EQ("nothing", testee.apply("nothing"));
+  EXPECT_EQ("", testee.apply(""));
+}
+
+TEST(SubstitutionDfa, SinglePass)
+{
+  SubstitutionDfa testee({text("a", "aa")});
+  EXPECT_EQ("aaaa", testee.apply("aa"));
+}
+
+TEST(SubstitutionDfa, LongestMatch)
+{
+  SubstitutionDfa testee({text("ab", "1"), text("abc", "2"), text("x", "3")});
+  EXPECT_EQ("2 1 3", testee.apply("abc ab x"));
+}
+
+TEST(SubstitutionDfa, LeftmostLongestRestarts)
+{
+  // longest match from the first 'a' needs look ahead to the end of text,
+  // so scan is restarted after the shorter match
+  SubstitutionDfa testee({regex("a*b", "B"), text("a", "A")});
+  EXPECT_EQ("B", testee.apply("aaab"));
+  EXPECT_EQ("AAA", testee.apply("aaa"));
+  EXPECT_EQ("AA B", testee.apply("aa ab"));
+}
+
+TEST(SubstitutionDfa, Word)
+{
+  SubstitutionDfa testee({word("l", "I")});
+  EXPECT_EQ("I am, I.", testee.apply("l am, l."));
+  EXPECT_EQ("hello", testee.apply("hello"));
+}
+
+TEST(SubstitutionDfa, Regex)
+{
+  SubstitutionDfa testee({regex("[0-9]+[.,][0-9]+", "N"),
+                          regex("a(b|c)*d", "X"), regex("\\s{2,}", " ")});
+  EXPECT_TRUE(testee.errors().isEmpty());
+  EXPECT_EQ("N and N", testee.apply("1.5 and 20,25"));
+  EXPECT_EQ("X-X-X", testee.apply("ad-abd-abcbcd"));
+  EXPECT_EQ("a b", testee.apply("a    b"));
+}
+
+TEST(SubstitutionDfa, RegexAnchors)
+{
+  SubstitutionDfa testee({regex("^-", ""), regex("\\bteh\\b", "the")});
+  EXPECT_EQ("item\nitem - x", testee.apply("-item\n-item - x"));
+  EXPECT_EQ("the tehran", testee.apply("teh tehran"));
+}
+
+TEST(SubstitutionDfa, RegexBackReferences)
+{
+  SubstitutionDfa testee({regex("(\\w+)-\\n(\\w+)", "\\1\\2")});
+  EXPECT_EQ("word rest", testee.apply("wo-\nrd rest"));
+}
+
+TEST(SubstitutionDfa, Errors)
+{
+  SubstitutionDfa testee({regex("(a", ""), regex("a(?=b)", ""),
+                          regex("*", ""), text("(a", "b")});
+  EXPECT_EQ(3, testee.errors().size());
+  EXPECT_EQ("b", testee.apply("(a"));
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include "task.h"
+#include "taskorder.h"
+
+namespace
+{
+TaskPtr task(Generation generation)
+{
+  auto result = std::make_shared<Task>();
+  result->generation = generation;
+  return result;
+}
+}  // namespace
+
+TEST(TaskOrder, InOrder)
+{
+  TaskOrder order;
+  const auto first = task(1);
+  const auto second = task(1);
+  order.add(first);
+  order.add(second);
+
+  EXPECT_EQ(std::vector<TaskPtr>{first}, order.finish(first));
+  EXPECT_EQ(std::vector<TaskPtr>{second}, order.finish(second));
+  EXPECT_EQ(0, order.size());
+}
+
+TEST(TaskOrder, ReorderInGeneration)
+{
+  TaskOrder order;
+  const auto first = task(1);
+  const auto second = task(1);
+  order.add(first);
+  order.add(second);
+
+  EXPECT_TRUE(order.finish(second).empty());
+  EXPECT_EQ(2, order.size());
+  EXPECT_EQ((std::vector<TaskPtr>{first, second}), order.finish(first));
+}
+
+TEST(TaskOrder, GenerationsAreIndependent)
+{
+  TaskOrder order;
+  const auto slow = task(1);
+  const auto fast = task(2);
+  order.add(slow);
+  order.add(fast);
+
+  EXPECT_EQ(std::vector<TaskPtr>{fast}, order.finish(fast));
+  EXPECT_TRUE(order.contains(slow));
+  EXPECT_FALSE(order.contains(fast));
+  EXPECT_EQ(std::vector<TaskPtr>{slow}, order.finish(slow));
+}
+
+TEST(TaskOrder, UnknownAndCleared)
+{
+  TaskOrder order;
+  const auto known = task(1);
+  order.add(known);
+  EXPECT_TRUE(order.finish(task(1)).empty());
+  EXPECT_TRUE(order.finish(task(3)).empty());
+
+  EXPECT_EQ(std::vector<TaskPtr>{known}, order.clear());
+  EXPECT_FALSE(order.contains(known));
+  EXPECT_TRUE(order.finish(known).empty());
+}
+
+TEST(TaskOrder, ClearedWhileRunning)
+{
+  TaskOrder order;
+  const auto running = task(1);
+  const auto finished = task(1);
+  const auto other = task(2);
+  order.add(running);
+  order.add(finished);
+  order.add(other);
+  EXPECT_TRUE(order.finish(finished).empty());
+
+  // every not passed task is returned, so none of them is lost
+  EXPECT_EQ((std::vector<TaskPtr>{running, finished, other}), order.clear());
+  EXPECT_EQ(0, order.size());
+  EXPECT_FALSE(order.contains(running));
+  EXPECT_TRUE(order.finish(running).empty());
+}
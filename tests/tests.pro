@@ -3,17 +3,48 @@ CONFIG -= app_bundle
 
 QT += widgets network testlib
 
-INCLUDEPATH += $$PWD/../external $$PWD/../src/service
+INCLUDEPATH += $$PWD/../external $$PWD/../src $$PWD/../src/service \
+  $$PWD/../src/capture $$PWD/../src/correct $$PWD/../src/ocr $$PWD/../src/translate
 
 HEADERS += \
   ../src/service/updates.h
 
 SOURCES += \
   ../external/gtest/gtest-all.cc \
+  ../src/capture/changedetector.cpp \
+  ../src/correct/confusionmatrix.cpp \
+  ../src/correct/ngramcorrector.cpp \
+  ../src/correct/ngrammodel.cpp \
+  ../src/correct/substitutiondfa.cpp \
+  ../src/languagecodes.cpp \
+  ../src/ocr/imagetiles.cpp \
+  ../src/ocr/incrementalrecognizer.cpp \
+  ../src/ocr/parallelismplanner.cpp \
+  ../src/ocr/pixpool.cpp \
+  ../src/ocr/textlayout.cpp \
+  ../src/pipeline.cpp \
   ../src/service/geometryutils.cpp \
+  ../src/service/latencymonitor.cpp \
+  ../src/service/memoryregistry.cpp \
   ../src/service/updates.cpp \
   ../src/service/debug.cpp \
+  ../src/taskorder.cpp \
+  ../src/translate/translationdiff.cpp \
   ../external/miniz/miniz.c \
+  changedetector_test.cpp \
+  confusionmatrix_test.cpp \
   geometryutils_test.cpp \
+  imagetiles_test.cpp \
+  incrementalrecognizer_test.cpp \
+  latencymonitor_test.cpp \
   main.cpp \
+  memoryregistry_test.cpp \
+  ngrammodel_test.cpp \
+  parallelismplanner_test.cpp \
+  pipeline_test.cpp \
+  pixpool_test.cpp \
+  substitutiondfa_test.cpp \
+  taskorder_test.cpp \
+  textlayout_test.cpp \
+  translationdiff_test.cpp \
   updates_test.cpp
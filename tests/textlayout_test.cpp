@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "textlayout.h"
+
+namespace
+{
+// two lines in one block, second line has one word
+TextLayout sample()
+{
+  TextLayout layout(QSize(200, 100));
+  layout.addWord({"Hello", QRect(10, 10, 50, 20), 95, 0, 0, 0});
+  layout.addWord({"<world>", QRect(70, 10, 60, 20), 80, 0, 0, 0});
+  layout.addWord({"Next", QRect(10, 40, 40, 20), 90, 0, 0, 1});
+  return layout;
+}
+}  // namespace
+
+TEST(TextLayout, Append)
+{
+  TextLayout layout(QSize(200, 300));
+  layout.append(sample(), {0, 0});
+  layout.append(sample(), {0, 100});
+
+  const auto &words = layout.words();
+  ASSERT_EQ(6, int(words.size()));
+  EXPECT_EQ(QRect(10, 110, 50, 20), words[3].rect);
+  EXPECT_EQ(1, words[3].block);
+  EXPECT_EQ(2, words[3].line);
+  EXPECT_EQ(3, words[5].line);
+}
+
+TEST(TextLayout, Hocr)
+{
+  const auto hocr = TextLayout::toString(LayoutFormat::Hocr, {sample()});
+  EXPECT_TRUE(hocr.contains(R"(id="page_1" title="bbox 0 0 200 100")"));
+  EXPECT_TRUE(hocr.contains(R"(title="bbox 10 10 60 30; x_wconf 95">Hello)"));
+  EXPECT_TRUE(hocr.contains("&lt;world&gt;"));
+  EXPECT_EQ(2, hocr.count(R"(class="ocr_line")"));
+  EXPECT_EQ(hocr.count("<span"), hocr.count("</span>"));
+  EXPECT_EQ(hocr.count("<div"), hocr.count("</div>"));
+}
+
+TEST(TextLayout, Alto)
+{
+  const auto alto = TextLayout::toString(LayoutFormat::Alto, {sample()});
+  EXPECT_TRUE(alto.contains(
+      R"(HPOS="10" VPOS="10" WIDTH="50" HEIGHT="20" WC="0.95" )"
+      R"(CONTENT="Hello")"));
+  EXPECT_EQ(1, alto.count("<TextBlock "));
+  EXPECT_EQ(2, alto.count("<TextLine "));
+  EXPECT_EQ(1, alto.count("<SP/>"));
+}
+
+TEST(TextLayout, Tsv)
+{
+  const auto tsv = TextLayout::toString(LayoutFormat::Tsv, {sample()});
+  const auto rows = tsv.split('\n', QString::SkipEmptyParts);
+  // header, page, block, paragraph, 2 lines, 3 words
+  ASSERT_EQ(9, rows.size());
+  EXPECT_EQ("5\t1\t1\t1\t2\t1\t10\t40\t40\t20\t90\tNext", rows.last());
+}
+
+TEST(TextLayout, EmptyPage)
+{
+  const auto tsv = TextLayout::toString(LayoutFormat::Tsv,
+                                        {TextLayout(QSize(10, 10))});
+  EXPECT_EQ(2, tsv.count('\n'));
+  EXPECT_TRUE(TextLayout::toString(LayoutFormat::None, {}).isEmpty());
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "translationdiff.h"
+
+TEST(TranslationDiff, AllNew)
+{
+  TranslationDiff testee;
+  EXPECT_EQ("one\ntwo", testee.changed("one\n\ntwo "));
+  EXPECT_EQ("1\n2", testee.apply("1\n2"));
+}
+
+TEST(TranslationDiff, NothingNew)
+{
+  TranslationDiff testee;
+  testee.changed("one\ntwo");
+  testee.apply("1\n2");
+  EXPECT_EQ("", testee.changed("one\ntwo"));
+  EXPECT_EQ("1\n2", testee.apply({}));
+}
+
+TEST(TranslationDiff, OnlyAppended)
+{
+  TranslationDiff testee;
+  testee.changed("one\ntwo");
+  testee.apply("1\n2");
+  EXPECT_EQ("three", testee.changed("two\nthree"));
+  EXPECT_EQ("2\n3", testee.apply("3"));
+}
+
+TEST(TranslationDiff, RecognitionJitter)
+{
+  TranslationDiff testee;
+  testee.changed("Hello, how are you doing today?");
+  testee.apply("hi");
+  EXPECT_EQ("", testee.changed("HeIlo, how are you doing today?"));
+  EXPECT_EQ("", testee.changed("Hello, how are you doing today"));
+  EXPECT_EQ("Goodbye", testee.changed("Goodbye"));
+}
+
+TEST(TranslationDiff, MergedLines)
+{
+  TranslationDiff testee;
+  testee.changed("zero");
+  testee.apply("0");
+  EXPECT_EQ("one\ntwo", testee.changed("zero\none\ntwo"));
+  EXPECT_EQ("0\n1 2", testee.apply("1 2"));
+
+  // merged lines are not cached, so following frame translates them again
+  EXPECT_EQ("one\ntwo", testee.changed("zero\none\ntwo"));
+  EXPECT_EQ("0\n1\n2", testee.apply("1\n2"));
+  EXPECT_EQ("", testee.changed("one\ntwo"));
+  EXPECT_EQ("1\n2", testee.apply({}));
+}
+
+TEST(TranslationDiff, Similarity)
+{
+  EXPECT_DOUBLE_EQ(1.0, TranslationDiff::similarity("", ""));
+  EXPECT_DOUBLE_EQ(1.0, TranslationDiff::similarity("abc", "abc"));
+  EXPECT_DOUBLE_EQ(0.0, TranslationDiff::similarity("abc", ""));
+  EXPECT_DOUBLE_EQ(0.75, TranslationDiff::similarity("abcd", "abed"));
+}